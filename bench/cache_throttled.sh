@@ -0,0 +1,51 @@
+#!/bin/sh
+# SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+#
+# SPDX-License-Identifier: GPL-3.0-or-later
+
+# Play a file from a bandwidth limited source with the cache options of the built-in
+# profiles and with the defaults of mpv, and count the stalls for filling the cache.
+#
+# usage: bench/cache_throttled.sh FILE [RATE] [SECONDS]
+#   FILE     video file, best a high bitrate file of the kind played from slow disks
+#   RATE     bandwidth of the source as taken by "pv -L", default 40m (bytes per second)
+#   SECONDS  played duration, default 120
+#
+# The file is piped through pv, so the kernel readahead of the player does not apply,
+# only the demuxer cache is compared. Requires mpv and pv.
+
+set -eu
+
+if [ $# -lt 1 ]; then
+	sed -n '/^# usage/,/^# only/s/^# \{0,1\}//p' "$0"
+	exit 1
+fi
+
+file=$1
+rate=${2:-40m}
+seconds=${3:-120}
+
+for tool in mpv pv; do
+	if ! command -v "$tool" > /dev/null; then
+		echo "$tool not found" >&2
+		exit 1
+	fi
+done
+
+run()
+{
+	name=$1
+	shift
+	log=$(mktemp)
+	start=$(date +%s.%N)
+	pv -q -L "$rate" "$file" | mpv --no-config --vo=null --ao=null --length="$seconds" --msg-level=all=v --log-file="$log" "$@" - > /dev/null 2>&1 || true
+	end=$(date +%s.%N)
+	stalls=$(grep -c "Enter buffering" "$log" || true)
+	echo "$name: $stalls stalls, $(awk "BEGIN { print $end - $start - $seconds }") s behind real time"
+	rm -f "$log"
+}
+
+echo "$file at $rate/s for $seconds s"
+run "mpv defaults"
+run "profile default" --cache=yes --demuxer-max-bytes=512MiB --demuxer-max-back-bytes=128MiB --demuxer-readahead-secs=20 --stream-buffer-size=4MiB
+run "profile large" --cache=yes --demuxer-max-bytes=2GiB --demuxer-max-back-bytes=256MiB --demuxer-readahead-secs=60 --stream-buffer-size=4MiB
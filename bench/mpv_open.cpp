@@ -0,0 +1,195 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* Time opening videos from the command to the first rendered frame,
+ * with a new mpv core and render context per file (cold) like before,
+ * and with "loadfile replace" in one running core (warm) like the player does now.
+ * The software render API is used, so neither a window nor the HMD is needed.
+ * All files are opened once before measuring, so both cases find them in the page cache.
+ *
+ *   g++ -std=c++14 -O2 -o mpv_open bench/mpv_open.cpp $(pkg-config --cflags --libs mpv) -pthread
+ *   ./mpv_open VIDEO...
+ */
+
+#include <mpv/client.h>
+#include <mpv/render.h>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+static const std::chrono::seconds frame_timeout(10);
+
+static std::mutex update_mutex;
+static std::condition_variable update_cv;
+static bool update_pending = false;
+
+typedef struct
+{
+	mpv_handle* mpv;
+	mpv_render_context* render;
+}
+core_t;
+
+static void on_render_update(void*)
+{
+	{
+		std::lock_guard<std::mutex> lock(update_mutex);
+		update_pending = true;
+	}
+	update_cv.notify_one();
+}
+
+static bool create_core(core_t& core)
+{
+	core.mpv = mpv_create();
+	core.render = nullptr;
+
+	if (!core.mpv)
+	{
+		return false;
+	}
+
+	mpv_set_option_string(core.mpv, "vo", "libmpv");
+	mpv_set_option_string(core.mpv, "ao", "null");
+	mpv_set_option_string(core.mpv, "keep-open", "always");
+	mpv_observe_property(core.mpv, 0, "duration", MPV_FORMAT_DOUBLE);
+	mpv_observe_property(core.mpv, 0, "time-pos", MPV_FORMAT_DOUBLE);
+
+	mpv_render_param params[] = {
+		{MPV_RENDER_PARAM_API_TYPE, const_cast<char*>(MPV_RENDER_API_TYPE_SW)},
+		{MPV_RENDER_PARAM_INVALID, nullptr}
+	};
+
+	if ((mpv_initialize(core.mpv) < 0) || (mpv_render_context_create(&core.render, core.mpv, params) < 0))
+	{
+		mpv_terminate_destroy(core.mpv);
+		return false;
+	}
+	mpv_render_context_set_update_callback(core.render, on_render_update, nullptr);
+	return true;
+}
+
+static void destroy_core(core_t& core)
+{
+	mpv_render_context_set_update_callback(core.render, nullptr, nullptr);
+	mpv_render_context_free(core.render);
+	mpv_terminate_destroy(core.mpv);
+}
+
+/** open a file and render its first frame.
+ * @return time in milliseconds, negative if no frame was rendered.
+ */
+static double first_frame(core_t& core, const char* file_name)
+{
+	const char* cmd[] = {"loadfile", file_name, "replace", nullptr};
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	int size[2] = {64, 64};
+	size_t stride = 4 * 64;
+	char format[] = "rgb0";
+	std::vector<uint8_t> pixels(stride * 64);
+	mpv_render_param params[] = {
+		{MPV_RENDER_PARAM_SW_SIZE, size},
+		{MPV_RENDER_PARAM_SW_FORMAT, format},
+		{MPV_RENDER_PARAM_SW_STRIDE, &stride},
+		{MPV_RENDER_PARAM_SW_POINTER, pixels.data()},
+		{MPV_RENDER_PARAM_INVALID, nullptr}
+	};
+
+	if (mpv_command(core.mpv, cmd) < 0)
+	{
+		return -1.0;
+	}
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(update_mutex);
+
+			if (!update_cv.wait_for(lock, frame_timeout, []{ return update_pending; }))
+			{
+				return -1.0;
+			}
+			update_pending = false;
+		}
+
+		if (mpv_render_context_update(core.render) & MPV_RENDER_UPDATE_FRAME)
+		{
+			mpv_render_context_render(core.render, params);
+			break;
+		}
+	}
+
+	const std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+
+	/* the events of the observed properties are not used */
+	while (mpv_wait_event(core.mpv, 0.0)->event_id != MPV_EVENT_NONE)
+	{
+	}
+	return time.count();
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		std::cerr << "usage: " << argv[0] << " VIDEO..." << std::endl;
+		return 1;
+	}
+
+	core_t warm;
+
+	if (!create_core(warm))
+	{
+		std::cerr << "could not create mpv core" << std::endl;
+		return 1;
+	}
+
+	for (int i = 1; i < argc; i++)
+	{
+		first_frame(warm, argv[i]);
+	}
+
+	double cold_sum = 0.0;
+	double warm_sum = 0.0;
+	int opened = 0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		core_t cold;
+
+		if (!create_core(cold))
+		{
+			std::cerr << "could not create mpv core" << std::endl;
+			break;
+		}
+
+		const double frame = first_frame(cold, argv[i]);
+		const std::chrono::duration<double, std::milli> cold_time = std::chrono::steady_clock::now() - start;
+
+		destroy_core(cold);
+
+		const double warm_time = first_frame(warm, argv[i]);
+
+		if ((frame < 0.0) || (warm_time < 0.0))
+		{
+			std::cout << argv[i] << ": no frame" << std::endl;
+			continue;
+		}
+
+		std::cout << argv[i] << ": cold " << cold_time.count() << " ms, warm " << warm_time << " ms" << std::endl;
+		cold_sum += cold_time.count();
+		warm_sum += warm_time;
+		opened++;
+	}
+
+	if (opened > 0)
+	{
+		std::cout << "mean of " << opened << " files: cold " << (cold_sum / opened) << " ms, warm " << (warm_sum / opened) << " ms" << std::endl;
+	}
+	destroy_core(warm);
+	return 0;
+}
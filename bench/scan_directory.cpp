@@ -0,0 +1,33 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/* Time listing the directory and file panels of the file browser for one directory.
+ * Built by bench/scan_directory.sh, with SCAN_ONCE for FileSystem::scan_directory(),
+ * otherwise with the separate file_names() and directory_names() scans.
+ */
+
+#include "util/file_system.h"
+#include <chrono>
+#include <iostream>
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		std::cerr << "usage: " << argv[0] << " DIRECTORY" << std::endl;
+		return 1;
+	}
+
+	FileSystem fs;
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+#ifdef SCAN_ONCE
+	const size_t entries = fs.scan_directory(argv[1], false).size();
+#else
+	const size_t entries = fs.directory_names(argv[1]).size() + fs.file_names(argv[1]).size();
+#endif
+	const std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+
+	std::cout << time.count() << " ms " << entries << " entries" << std::endl;
+	return 0;
+}
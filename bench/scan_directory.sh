@@ -0,0 +1,64 @@
+#!/bin/sh
+# SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+#
+# SPDX-License-Identifier: GPL-3.0-or-later
+
+# Compare listing a large directory in the file browser before and after the single pass scan.
+#
+# usage: bench/scan_directory.sh [ENTRIES] [PARENT] [RUNS]
+#   ENTRIES  number of entries of the generated directory, default 100000
+#   PARENT   directory to create it in, default /dev/shm (tmpfs)
+#   RUNS     number of runs, the median is reported, default 5
+#
+# One tenth of the entries are directories, the files are a mix of videos, images and
+# other files. Runs after the first one find the directory in the kernel caches.
+# Requires g++ and zlib, and a git checkout for building the previous version.
+
+set -eu
+
+entries=${1:-100000}
+parent=${2:-/dev/shm}
+runs=${3:-5}
+root=$(cd "$(dirname "$0")/.." && pwd)
+work=$(mktemp -d "$parent/cine-vr-scan.XXXXXX")
+trap 'rm -rf "$work"' EXIT
+
+echo "creating $entries entries in $work"
+mkdir "$work/dir" "$work/before"
+(
+	cd "$work/dir"
+	i=0
+	while [ $i -lt "$entries" ]; do
+		case $((i % 10)) in
+			0) mkdir "d$i" ;;
+			1|2|3) : > "v$i.mp4" ;;
+			4|5|6) : > "i$i.jpg" ;;
+			*) : > "f$i.txt" ;;
+		esac
+		i=$((i + 1))
+	done
+)
+
+# the version before the first commit providing scan_directory()
+first=$(git -C "$root" log --format=%H -S scan_directory -- source/util/file_system.h | tail -n 1)
+mkdir -p "$work/before/util"
+for file in file_system.h file_system.cpp zip_archive.h zip_archive.cpp; do
+	git -C "$root" show "$first^:source/util/$file" > "$work/before/util/$file"
+done
+
+flags="-std=c++14 -O2"
+g++ $flags -I"$work/before" -o "$work/scan_before" "$root/bench/scan_directory.cpp" "$work/before/util/file_system.cpp" "$work/before/util/zip_archive.cpp" -lz
+g++ $flags -DSCAN_ONCE -I"$root/source" -o "$work/scan_after" "$root/bench/scan_directory.cpp" "$root/source/util/file_system.cpp" "$root/source/util/zip_archive.cpp" "$root/source/util/string_tools.cpp" -lz
+
+median()
+{
+	binary=$1
+	i=0
+	while [ $i -lt "$runs" ]; do
+		"$binary" "$work/dir"
+		i=$((i + 1))
+	done | sort -n | awk '{ time[NR] = $1; count = $3 } END { print time[int((NR + 1) / 2)] " ms for " count " entries" }'
+}
+
+echo "before ($(git -C "$root" rev-parse --short "$first^")): $(median "$work/scan_before")"
+echo "after: $(median "$work/scan_after")"
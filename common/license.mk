@@ -10,8 +10,8 @@ license-lint:
 	reuse lint
 
 license-annotate:
-	reuse annotate --merge-copyrights --year $(shell date "+%Y") --copyright $(COPYRIGHT) --license $(LICENSE_CODE) Makefile README.md .gitignore common/*.mk .github/workflows/build.yml
-	reuse annotate --merge-copyrights --year $(shell date "+%Y") --copyright $(COPYRIGHT) --license $(LICENSE_CODE) --style cpp source/* source/*/* shaders/*.glsl actions/*.json
+	reuse annotate --merge-copyrights --year $(shell date "+%Y") --copyright $(COPYRIGHT) --license $(LICENSE_CODE) Makefile README.md .gitignore common/*.mk bench/*.sh .github/workflows/build.yml
+	reuse annotate --merge-copyrights --year $(shell date "+%Y") --copyright $(COPYRIGHT) --license $(LICENSE_CODE) --style cpp source/* source/*/* bench/*.cpp shaders/*.glsl actions/*.json
 	reuse annotate --merge-copyrights --year $(shell date "+%Y") --copyright $(COPYRIGHT) --license $(LICENSE_CODE) --style python common/*.cfg
 	reuse annotate --merge-copyrights --year $(shell date "+%Y") --copyright $(COPYRIGHT) --license $(LICENSE_IMAGE) images/*.svg
 	-reuse download $(LICENSE_CODE) $(LICENSE_IMAGE)
@@ -0,0 +1,89 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#version 330 core
+
+uniform sampler2D diffuse0;
+uniform vec2 texture_offset;
+uniform vec2 texture_scale;
+uniform bool cube_stereo;
+uniform bool eac;             // equi-angular cube map, faces sampled at equal angles
+uniform int face;             // 0 to 5 for +x, -x, +y, -y, +z, -z
+
+in vec2 faceCoords;
+
+out vec4 outColor;
+
+const float pi = 3.14159265358979;
+
+// texture coordinates of the cube faces, same layout as the cube map meshes
+vec2 cube_map(vec3 n)
+{
+	vec3 a = abs(n);
+
+	if ((a.x >= a.y) && (a.x >= a.z))
+	{
+		if (cube_stereo)
+		{
+			return (n.x > 0.0) ? vec2((1.0 - n.y) / 4.0, (1.0 - n.z) / 6.0) :
+			                     vec2((1.0 - n.y) / 4.0, 2.0 / 3.0 + (n.z + 1.0) / 6.0);
+		}
+		return (n.x > 0.0) ? vec2(2.0 / 3.0 + (n.z + 1.0) / 6.0, (1.0 - n.y) / 4.0) :
+		                     vec2((1.0 - n.z) / 6.0, (1.0 - n.y) / 4.0);
+	}
+
+	if (a.y >= a.z)
+	{
+		if (cube_stereo)
+		{
+			return (n.y > 0.0) ? vec2(0.5 + (1.0 - n.x) / 4.0, (n.z + 1.0) / 6.0) :
+			                     vec2(0.5 + (1.0 - n.x) / 4.0, 2.0 / 3.0 + (1.0 - n.z) / 6.0);
+		}
+		return (n.y > 0.0) ? vec2(2.0 / 3.0 + (1.0 - n.z) / 6.0, 0.5 + (1.0 - n.x) / 4.0) :
+		                     vec2((n.z + 1.0) / 6.0, 0.5 + (1.0 - n.x) / 4.0);
+	}
+
+	if (cube_stereo)
+	{
+		return (n.z < 0.0) ? vec2((1.0 - n.y) / 4.0, 1.0 / 3.0 + (1.0 - n.x) / 6.0) :
+		                     vec2(0.5 + (1.0 - n.x) / 4.0, 1.0 / 3.0 + (1.0 - n.y) / 6.0);
+	}
+	return (n.z < 0.0) ? vec2(1.0 / 3.0 + (n.x + 1.0) / 6.0, (1.0 - n.y) / 4.0) :
+	                     vec2(1.0 / 3.0 + (n.y + 1.0) / 6.0, 0.5 + (1.0 - n.x) / 4.0);
+}
+
+// direction of a texel of a cube map face, following the OpenGL face orientation
+vec3 face_direction(vec2 st)
+{
+	if (face == 0)
+	{
+		return vec3(1.0, -st.y, -st.x);
+	}
+	else if (face == 1)
+	{
+		return vec3(-1.0, -st.y, st.x);
+	}
+	else if (face == 2)
+	{
+		return vec3(st.x, 1.0, st.y);
+	}
+	else if (face == 3)
+	{
+		return vec3(st.x, -1.0, -st.y);
+	}
+	else if (face == 4)
+	{
+		return vec3(st.x, -st.y, 1.0);
+	}
+	return vec3(-st.x, -st.y, -1.0);
+}
+
+void main(void)
+{
+	// EAC stores the face at equal angles instead of equal distances on the face plane
+	vec2 st = eac ? atan(faceCoords) * (4.0 / pi) : faceCoords;
+	vec2 tex = cube_map(face_direction(st));
+
+	outColor = texture(diffuse0, tex * texture_scale + texture_offset);
+}
@@ -0,0 +1,15 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#version 330 core
+
+layout(location = 0) in vec3 pos;
+
+out vec2 faceCoords;
+
+void main()
+{
+	faceCoords = pos.xy;
+	gl_Position = vec4(pos.xy, 0.0, 1.0);
+}
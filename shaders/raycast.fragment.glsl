@@ -0,0 +1,135 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#version 330 core
+
+// values of Projection::video_projection_t
+const int PROJECTION_FLAT = 0;
+const int PROJECTION_CYLINDER = 1;
+const int PROJECTION_SPHERE = 2;
+const int PROJECTION_FISHEYE = 3;
+const int PROJECTION_CUBE_MAP = 4;
+
+const float pi = 3.14159265358979;
+const float eps = 1.0e-6;
+
+uniform sampler2D diffuse0;
+uniform samplerCube cube0;
+uniform bool greyscale;
+uniform mat4 projview;
+uniform mat4 model;
+uniform vec2 texture_offset;
+uniform vec2 texture_scale;
+
+uniform int projection;
+uniform float angle;
+uniform float zoom;
+uniform float radius;
+uniform float focus;
+uniform vec2 screen_size;     // half width and half height of a flat screen, height of a cylinder
+
+in vec4 rayNear;
+in vec4 rayFar;
+
+out vec4 outColor;
+
+// distance to the far intersection of a ray with a sphere
+float sphere_exit(vec3 origin, vec3 dir, vec3 center)
+{
+	vec3 oc = origin - center;
+	float b = dot(oc, dir);
+	float h = b * b - dot(oc, oc) + radius * radius;
+
+	return (h < 0.0) ? -1.0 : (sqrt(h) - b);
+}
+
+// distance to the far intersection of a ray with a vertical cylinder
+float cylinder_exit(vec3 origin, vec3 dir, vec3 center)
+{
+	vec2 oc = origin.xz - center.xz;
+	float a = dot(dir.xz, dir.xz);
+	float b = dot(oc, dir.xz);
+	float h = b * b - a * (dot(oc, oc) - radius * radius);
+
+	return ((h < 0.0) || (a < eps)) ? -1.0 : ((sqrt(h) - b) / a);
+}
+
+// distance to the far intersection of a ray with a cube centered at the origin
+float cube_exit(vec3 origin, vec3 dir)
+{
+	vec3 s = 2.0 * step(0.0, dir) - 1.0;
+	vec3 d = mix(s * eps, dir, step(eps, abs(dir)));
+	vec3 t = (s * radius - origin) / d;
+
+	return min(min(t.x, t.y), t.z);
+}
+
+void main(void)
+{
+	vec3 origin = rayNear.xyz / rayNear.w;
+	vec3 dir = normalize(rayFar.xyz / rayFar.w - origin);
+	vec3 center = vec3(0.0, 0.0, -zoom);
+	float t = -1.0;
+	vec2 tex = vec2(0.0, 0.0);
+
+	if (projection == PROJECTION_FLAT)
+	{
+		float screen_distance = radius + zoom;
+
+		t = (dir.z < -eps) ? ((-screen_distance - origin.z) / dir.z) : -1.0;
+
+		vec3 p = origin + t * dir;
+		tex = vec2(0.5 + 0.5 * p.x / screen_size.x, 0.5 - 0.5 * p.y / screen_size.y);
+	}
+	else if (projection == PROJECTION_CYLINDER)
+	{
+		t = cylinder_exit(origin, dir, center);
+
+		vec3 q = origin + t * dir - center;
+		tex = vec2(atan(q.x, -q.z) / angle + 0.5, 0.5 - q.y / screen_size.y);
+	}
+	else if (projection == PROJECTION_SPHERE)
+	{
+		t = sphere_exit(origin, dir, center);
+
+		vec3 q = origin + t * dir - center;
+		tex = vec2(atan(q.x, -q.z) / angle + 0.5, acos(clamp(q.y / radius, -1.0, 1.0)) / pi);
+	}
+	else if (projection == PROJECTION_FISHEYE)
+	{
+		t = sphere_exit(origin, dir, center);
+
+		// inverse of the equisolid mapping r = sin(theta / 2) / focus
+		vec3 q = origin + t * dir - center;
+		float theta = acos(clamp(-q.z / radius, -1.0, 1.0));
+		float r = (focus > eps) ? (sin(0.5 * theta) / focus) : 0.0;
+		float len = length(q.xy);
+		tex = (len < eps) ? vec2(0.5, 0.5) : (vec2(0.5, 0.5) + r * vec2(q.x, -q.y) / len);
+	}
+	else if (projection == PROJECTION_CUBE_MAP)
+	{
+		t = cube_exit(origin, dir);
+	}
+
+	if ((t < 0.0) || any(lessThan(tex, vec2(0.0, 0.0))) || any(greaterThan(tex, vec2(1.0, 1.0))))
+	{
+		discard;
+	}
+
+	// cube maps are repacked into a native cube map texture and sampled by direction
+	vec4 texColor = (projection == PROJECTION_CUBE_MAP) ?
+	                texture(cube0, origin + t * dir) :
+	                texture(diffuse0, tex * texture_scale + texture_offset);
+
+	if (greyscale)
+	{
+		float grey = dot(texColor.rgb, vec3(0.299, 0.587, 0.114));
+		texColor = vec4(grey, grey, grey, texColor.a);
+	}
+	outColor = texColor;
+
+	// depth of the canvas surface, so the menu is still occluded correctly
+	vec4 clip = projview * model * vec4(origin + t * dir, 1.0);
+	gl_FragDepth = 0.5 * clip.z / clip.w + 0.5;
+}
@@ -0,0 +1,21 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#version 330 core
+
+layout(location = 0) in vec3 pos;
+
+uniform mat4 inverse_transform;
+
+out vec4 rayNear;
+out vec4 rayFar;
+
+void main()
+{
+	// corners of the view frustum in canvas coordinates,
+	// the perspective division is done per fragment
+	rayNear = inverse_transform * vec4(pos.xy, -1.0, 1.0);
+	rayFar = inverse_transform * vec4(pos.xy, 1.0, 1.0);
+	gl_Position = vec4(pos.xy, 0.0, 1.0);
+}
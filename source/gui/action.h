@@ -15,6 +15,7 @@ typedef enum
 	ACTION_FILE_SELECT,
 	ACTION_FILE_DELETE,
 	ACTION_FILE_OPEN,
+	ACTION_RECENT_SELECT,
 	ACTION_PLAY_BACKWARD,
 	ACTION_PLAY_FORWARD,
 	ACTION_PLAY_NEXT,
@@ -29,14 +30,18 @@ typedef enum
 	ACTION_PROJECT_FLAT,
 	ACTION_PROJECT_SPHERE,
 	ACTION_SETTINGS,
+	ACTION_STATS,
 	ACTION_TILE_CUBE_MONO,
 	ACTION_TILE_CUBE_STEREO,
+	ACTION_TILE_EAC_MONO,
+	ACTION_TILE_EAC_STEREO,
 	ACTION_TILE_LEFT_RIGHT,
 	ACTION_TILE_MONO,
 	ACTION_TILE_TOP_BOTTOM,
 	ACTION_FLAG_MONO,
 	ACTION_FLAG_STRETCH,
 	ACTION_FLAG_SWITCH_EYES,
+	ACTION_FLAG_RAYCAST,
 	ACTION_PARAM_ANGLE,
 	ACTION_PARAM_ZOOM,
 	ACTION_VOLUME
@@ -9,9 +9,15 @@
 #include "toggle_button.h"
 #include "slide_button.h"
 #include "progress_bar.h"
+#include "stats_panel.h"
 
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
+#include <sstream>
+#include <iomanip>
+
+/* number of newest files of the media library listed in the file manager */
+static const size_t recent_files = 50;
 
 // #define DEBUG_LINE std::cout << "########## " << __FILE__ << "(" << __LINE__ << "): " << __FUNCTION__ << "()" << std::endl
 
@@ -76,7 +82,7 @@ void Menu::draw(void) const
 	}
 }
 
-void Menu::list_directories(LinePanel& panel) const
+void Menu::list_directories(LinePanel& panel, const std::vector<FileSystem::directory_entry_t>& scan) const
 {
 	FileSystem fs;
 	std::vector<std::string> entries = fs.split_path(m_current_directory);
@@ -93,27 +99,62 @@ void Menu::list_directories(LinePanel& panel) const
 	}
 
 	entries.push_back("");
-	std::set<std::string> dirs = fs.directory_names(m_current_directory);
-	for (std::set<std::string>::const_iterator iter = dirs.begin(); iter != dirs.end(); iter++)
+	for (std::vector<FileSystem::directory_entry_t>::const_iterator iter = scan.begin(); iter != scan.end(); iter++)
 	{
-		entries[entries.size() - 1] = *iter;
-		const std::string full = fs.join_path(entries.begin(), entries.end());
-		panel.add_line(*iter, full, i);
+		if (iter->is_directory)
+		{
+			entries[entries.size() - 1] = iter->name;
+			const std::string full = fs.join_path(entries.begin(), entries.end());
+			panel.add_line(iter->name, full, i);
+		}
 	}
 	panel.render_lines();
 }
 
-void Menu::list_files(LinePanel& panel) const
+void Menu::list_files(LinePanel& panel, const std::vector<FileSystem::directory_entry_t>& scan) const
 {
-	FileSystem fs;
-	std::set<std::string> entries = fs.file_names(m_current_directory);
+	const MediaLibrary& lib = library();
 
 	panel.clear_lines();
 
-	for (std::set<std::string>::const_iterator iter = entries.begin(); iter != entries.end(); iter++)
+	for (std::vector<FileSystem::directory_entry_t>::const_iterator iter = scan.begin(); iter != scan.end(); iter++)
 	{
-		const std::string full = m_current_directory + "/" + *iter;
-		panel.add_line(*iter, full, 0);
+		if (!iter->is_directory)
+		{
+			const std::string full = m_current_directory + "/" + iter->name;
+			MediaLibrary::media_info_t info = {};
+			std::ostringstream text;
+
+			text << iter->name;
+
+			/* dimensions and duration are known for files indexed by the media library */
+			if (lib.lookup(full, info) && (info.width > 0) && (info.height > 0))
+			{
+				text << "  " << info.width << "x" << info.height;
+
+				if (info.duration > 0)
+				{
+					text << ", " << (info.duration / 60000) << ":" << std::setw(2) << std::setfill('0') << ((info.duration / 1000) % 60);
+				}
+			}
+			panel.add_line(text.str(), full, 0);
+		}
+	}
+	panel.render_lines();
+}
+
+/** list the most recently modified media files of the library, newest first.
+ * @param panel panel to fill.
+ */
+void Menu::list_recent(LinePanel& panel) const
+{
+	const std::vector<MediaLibrary::media_info_t> recent = library().sorted(MediaLibrary::SORT_MTIME, 0, recent_files);
+
+	panel.clear_lines();
+
+	for (std::vector<MediaLibrary::media_info_t>::const_iterator iter = recent.begin(); iter != recent.end(); ++iter)
+	{
+		panel.add_line(iter->file_name.substr(iter->file_name.rfind('/') + 1), iter->file_name, 0);
 	}
 	panel.render_lines();
 }
@@ -234,6 +275,12 @@ void Menu::create_button_panel(const std::vector<action_t>& actions)
 				case ACTION_TILE_CUBE_STEREO:
 					b = new SimpleButton(ACTION_TILE_CUBE_STEREO, "images/cube-stereo.png");
 					break;
+				case ACTION_TILE_EAC_MONO:
+					b = new SimpleButton(ACTION_TILE_EAC_MONO, "images/eac-mono.png");
+					break;
+				case ACTION_TILE_EAC_STEREO:
+					b = new SimpleButton(ACTION_TILE_EAC_STEREO, "images/eac-stereo.png");
+					break;
 				case ACTION_TILE_LEFT_RIGHT:
 					b = new SimpleButton(ACTION_TILE_LEFT_RIGHT, "images/left-right.png");
 					break;
@@ -252,6 +299,9 @@ void Menu::create_button_panel(const std::vector<action_t>& actions)
 				case ACTION_FLAG_SWITCH_EYES:
 					b = new ToggleButton(act, "images/switch-eyes.png", projection().switch_eyes());
 					break;
+				case ACTION_FLAG_RAYCAST:
+					b = new ToggleButton(act, "images/raycast.png", projection().raycast());
+					break;
 				case ACTION_PARAM_ANGLE:
 					b = new SlideButton(act, "images/angle.png", 0.0f, 2.0f * glm::pi<float>(), projection().angle());
 					break;
@@ -300,6 +350,16 @@ void Menu::main_menu(void)
 		pose = m_hmd_pose * pose;
 		p->set_transform(pose);
 		m_panel[ACTION_PLAY_POSITION] = p;
+
+		// playback statistics above the progress bar
+		const float rot_angle = 0.0625f * glm::pi<float>();
+		p = new StatsPanel(ACTION_STATS);
+		pose = glm::mat4(1.0f);
+		pose = glm::rotate(pose, rot_angle, glm::vec3(1.0f, 0.0f, 0.0f));
+		pose = glm::translate(pose, glm::vec3(0.0f, 0.0f, -5.0f));
+		pose = m_hmd_pose * pose;
+		p->set_transform(pose);
+		m_panel[ACTION_STATS] = p;
 	}
 	else
 	{
@@ -321,7 +381,9 @@ void Menu::tiling_menu(void)
 		ACTION_TILE_LEFT_RIGHT,
 		ACTION_TILE_TOP_BOTTOM,
 		ACTION_TILE_CUBE_MONO,
-		ACTION_TILE_CUBE_STEREO
+		ACTION_TILE_CUBE_STEREO,
+		ACTION_TILE_EAC_MONO,
+		ACTION_TILE_EAC_STEREO
 	});
 }
 
@@ -389,9 +451,13 @@ void Menu::file_menu(void)
 	pose = glm::translate(pose, glm::vec3(0.0f, 0.0f, -5.0f));
 	pose = m_hmd_pose * pose;
 
+	/* directories and files are listed from a single scan */
+	FileSystem fs;
+	const std::vector<FileSystem::directory_entry_t> entries = fs.scan_directory(m_current_directory, false);
+
 	LinePanel* p = new LinePanel(ACTION_DIRECTORY_SELECT, "directories");
 	p->set_transform(pose);
-	list_directories(*p);
+	list_directories(*p, entries);
 	m_panel[ACTION_DIRECTORY_SELECT] = p;
 
 	// file panel
@@ -402,8 +468,19 @@ void Menu::file_menu(void)
 
 	p = new LinePanel(ACTION_FILE_SELECT, "files");
 	p->set_transform(pose);
-	list_files(*p);
+	list_files(*p, entries);
 	m_panel[ACTION_FILE_SELECT] = p;
+
+	// recently modified files of the media library
+	pose = glm::mat4(1.0f);
+	pose = glm::rotate(pose, -2.5f * rot_angle, glm::vec3(0.0f, 1.0f, 0.0f));
+	pose = glm::translate(pose, glm::vec3(0.0f, 0.0f, -5.0f));
+	pose = m_hmd_pose * pose;
+
+	p = new LinePanel(ACTION_RECENT_SELECT, "recent");
+	p->set_transform(pose);
+	list_recent(*p);
+	m_panel[ACTION_RECENT_SELECT] = p;
 }
 
 void Menu::settings_menu(void)
@@ -429,6 +506,12 @@ void Menu::settings_menu(void)
 		case Projection::TILE_CUBE_MAP_STEREO:
 			action_tile = ACTION_TILE_CUBE_STEREO;
 			break;
+		case Projection::TILE_EAC_MONO:
+			action_tile = ACTION_TILE_EAC_MONO;
+			break;
+		case Projection::TILE_EAC_STEREO:
+			action_tile = ACTION_TILE_EAC_STEREO;
+			break;
 		default:
 			throw std::runtime_error("invalid video tiling");
 	}
@@ -461,6 +544,7 @@ void Menu::settings_menu(void)
 		ACTION_FLAG_MONO,
 		ACTION_FLAG_STRETCH,
 		ACTION_FLAG_SWITCH_EYES,
+		ACTION_FLAG_RAYCAST,
 		ACTION_PARAM_ANGLE,
 		ACTION_PARAM_ZOOM,
 		ACTION_BACK
@@ -485,11 +569,14 @@ void Menu::handle_button_action(const action_t action)
 		{
 			LinePanel& panel = *dynamic_cast<LinePanel*>(m_panel.find(action)->second);
 			m_current_directory = panel.get_selection();
-			list_directories(panel);
-			list_files(*dynamic_cast<LinePanel*>(m_panel.find(ACTION_FILE_SELECT)->second));
+			FileSystem fs;
+			const std::vector<FileSystem::directory_entry_t> entries = fs.scan_directory(m_current_directory, false);
+			list_directories(panel, entries);
+			list_files(*dynamic_cast<LinePanel*>(m_panel.find(ACTION_FILE_SELECT)->second), entries);
 		}
 		break;
 		case ACTION_FILE_SELECT:
+		case ACTION_RECENT_SELECT:
 		{
 			m_submenu = MENU_NONE;
 			LinePanel& panel = *dynamic_cast<LinePanel*>(m_panel.find(action)->second);
@@ -620,6 +707,32 @@ void Menu::handle_button_action(const action_t action)
 				settings_menu();
 			}
 			break;
+		case ACTION_TILE_EAC_MONO:
+
+			if (m_submenu == MENU_SETTINGS)
+			{
+				tiling_menu();
+			}
+			else
+			{
+				projection().set_tiling(Projection::TILE_EAC_MONO);
+				update_projection();
+				settings_menu();
+			}
+			break;
+		case ACTION_TILE_EAC_STEREO:
+
+			if (m_submenu == MENU_SETTINGS)
+			{
+				tiling_menu();
+			}
+			else
+			{
+				projection().set_tiling(Projection::TILE_EAC_STEREO);
+				update_projection();
+				settings_menu();
+			}
+			break;
 		case ACTION_TILE_LEFT_RIGHT:
 
 			if (m_submenu == MENU_SETTINGS)
@@ -671,6 +784,10 @@ void Menu::handle_button_action(const action_t action)
 			projection().set_switch_eyes(!projection().switch_eyes());
 			update_projection();
 			break;
+		case ACTION_FLAG_RAYCAST:
+			projection().set_raycast(!projection().raycast());
+			update_projection();
+			break;
 		case ACTION_PARAM_ANGLE:
 			projection().set_angle(dynamic_cast<SlideButton*>(m_panel.find(action)->second)->slide_value());
 			update_projection();
@@ -728,7 +845,8 @@ void Menu::checkMenuInteraction(const glm::mat4& controller, const glm::mat4& hm
 			intersections.push_back(isec.global);
 		}
 
-		if (isec.hit && !input.trigger.button.pressed && !input.trigger.button.released)
+		/* the focus stays on a panel from pressing the trigger until letting it go */
+		if (isec.hit && !input.trigger.button.pressed && !input.trigger.button.released && !input.trigger.button.lifted)
 		{
 			m_focus = iter->first;
 		}
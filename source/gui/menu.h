@@ -7,6 +7,7 @@
 
 #include "line_panel.h"
 #include "util/openvr_interface.h"
+#include "util/file_system.h"
 #include <map>
 
 class Menu
@@ -34,8 +35,9 @@ class Menu
 
 		void create_button_panel(const std::vector<action_t>& actions);
 		void create_points(void);
-		void list_directories(LinePanel& panel) const;
-		void list_files(LinePanel& panel) const;
+		void list_directories(LinePanel& panel, const std::vector<FileSystem::directory_entry_t>& scan) const;
+		void list_files(LinePanel& panel, const std::vector<FileSystem::directory_entry_t>& scan) const;
+		void list_recent(LinePanel& panel) const;
 
 		void main_menu(void);
 		void tiling_menu(void);
@@ -0,0 +1,151 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "mesh_cache.h"
+#include <algorithm>
+
+MeshCache::MeshCache(const size_t capacity) :
+	m_entries(),
+	m_selected(),
+	m_current(nullptr),
+	m_capacity(std::max(capacity, static_cast<size_t>(2)))
+{
+}
+
+MeshCache::~MeshCache(void)
+{
+	clear();
+}
+
+/** release all meshes from the GPU.
+ */
+void MeshCache::clear(void)
+{
+	for (std::list<entry_t>::iterator iter = m_entries.begin(); iter != m_entries.end(); ++iter)
+	{
+		delete iter->shape;
+	}
+	m_entries.clear();
+	m_current = nullptr;
+}
+
+/** select the mesh to draw.
+ * If the mesh is cached, it is drawn from now on.
+ * Otherwise, the previous mesh is kept on screen, until the mesh with the selected key is inserted.
+ * @param key mesh key of the projection settings, see Projection::mesh_key().
+ * @return flag, whether the mesh was cached.
+ */
+bool MeshCache::select(const std::string& key)
+{
+	m_selected = key;
+
+	for (std::list<entry_t>::iterator iter = m_entries.begin(); iter != m_entries.end(); ++iter)
+	{
+		if (iter->key == key)
+		{
+			m_entries.splice(m_entries.begin(), m_entries, iter);
+			m_current = m_entries.front().shape;
+			return true;
+		}
+	}
+	return false;
+}
+
+/** upload a mesh to the GPU.
+ * When the cache is full, the buffers of the least recently used mesh are reused.
+ * The mesh currently on screen is never evicted.
+ * @param key mesh key of the projection settings the mesh was generated for.
+ * @param vertices vertices of the mesh.
+ * @param indices triangle indices of the mesh.
+ */
+void MeshCache::insert(const std::string& key, const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices)
+{
+	std::list<entry_t>::iterator entry = m_entries.end();
+
+	for (std::list<entry_t>::iterator iter = m_entries.begin(); iter != m_entries.end(); ++iter)
+	{
+		if (iter->key == key)
+		{
+			entry = iter;
+			break;
+		}
+	}
+
+	if ((entry == m_entries.end()) && (m_entries.size() >= m_capacity))
+	{
+		for (std::list<entry_t>::iterator iter = m_entries.end(); iter != m_entries.begin();)
+		{
+			--iter;
+
+			if (iter->shape != m_current)
+			{
+				entry = iter;
+				entry->key = key;
+				break;
+			}
+		}
+	}
+
+	if (entry == m_entries.end())
+	{
+		const entry_t e = {key, new Shape()};
+		m_entries.push_front(e);
+		entry = m_entries.begin();
+	}
+	else
+	{
+		m_entries.splice(m_entries.begin(), m_entries, entry);
+	}
+
+	m_entries.front().shape->update_vertices(vertices, indices);
+
+	if (key == m_selected)
+	{
+		m_current = m_entries.front().shape;
+	}
+}
+
+/** generate the meshes of all projections for the given settings in advance.
+ * Switching between the projections afterwards only selects another cached mesh,
+ * ray cast projections need no mesh.
+ * @param projection current projection settings.
+ */
+void MeshCache::warm(const Projection& projection)
+{
+	for (int p = 0; p < Projection::NUM_PROJECTIONS; p++)
+	{
+		Projection variant = projection;
+		variant.set_projection(static_cast<Projection::video_projection_t>(p));
+
+		if (variant.use_raycast() || (variant.projection() == projection.projection()))
+		{
+			continue;
+		}
+
+		const std::pair<std::vector<Vertex>, std::vector<GLuint> > mesh = variant.setup_projection();
+
+		insert(variant.mesh_key(), mesh.first, mesh.second);
+	}
+}
+
+/** set the model transformation of the mesh on screen.
+ * @param transform model transformation.
+ */
+void MeshCache::set_transform(const glm::mat4& transform) const
+{
+	if (m_current)
+	{
+		m_current->set_transform(transform);
+	}
+}
+
+/** draw the mesh on screen.
+ */
+void MeshCache::draw(void) const
+{
+	if (m_current)
+	{
+		m_current->draw();
+	}
+}
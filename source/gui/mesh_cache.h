@@ -0,0 +1,44 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include "projection.h"
+#include "opengl/shape.h"
+#include <string>
+#include <list>
+
+class MeshCache
+{
+	private:
+		typedef struct
+		{
+			std::string key;
+			Shape* shape;
+		}
+		entry_t;
+
+		std::list<entry_t> m_entries;     // most recently used first
+		std::string m_selected;
+		const Shape* m_current;
+		size_t m_capacity;
+
+		MeshCache(const MeshCache&);
+		MeshCache& operator=(const MeshCache&);
+
+	public:
+		explicit MeshCache(const size_t capacity = 8);
+		~MeshCache(void);
+
+		bool select(const std::string& key);
+		void insert(const std::string& key, const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices);
+		void warm(const Projection& projection);
+		void clear(void);
+
+		void set_transform(const glm::mat4& transform) const;
+		void draw(void) const;
+};
+
+#endif
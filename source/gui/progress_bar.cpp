@@ -8,12 +8,18 @@
 
 static const float tex2shape = 0.01f;
 
+/* width of the thumbnail preview relative to the progress bar */
+static const float thumbnail_scale = 0.25f;
+
 ProgressBar::ProgressBar(const action_t action, const std::string& image, const float max, const float pos) :
 	Panel(action),
 	m_progress_max(max),
 	m_progress_pos(pos),
+	m_dragging(false),
 	m_cursor(),
-	m_cursor_tex()
+	m_cursor_tex(),
+	m_thumbnail(),
+	m_thumbnail_visible(false)
 {
 	init_texture(image);
 	const glm::vec4 color(0.0f, 0.0f, 0.0f, 0.0f);
@@ -82,19 +88,86 @@ void ProgressBar::draw(void) const
 	m_cursor_tex.bind();
 	m_cursor.draw();
 	m_cursor_tex.unbind();
+
+	if (m_thumbnail_visible)
+	{
+		player().bind_thumbnails();
+		m_thumbnail.draw();
+		player().unbind_thumbnails();
+	}
+}
+
+/** show the thumbnail of the position pointed at above the progress bar.
+ * @param frac position along the progress bar from 0 to 1.
+ * @return flag, whether a thumbnail is available.
+ */
+bool ProgressBar::show_thumbnail(const float frac)
+{
+	glm::vec2 first;
+	glm::vec2 last;
+
+	if (!player().thumbnail(m_progress_max * frac, first, last))
+	{
+		return false;
+	}
+
+	const float eps = 2e-4f;
+	const glm::vec2 bar_size = tex2shape * glm::vec2(texture().size());
+	const glm::vec2 size(thumbnail_scale * bar_size.x, thumbnail_scale * bar_size.x / player().thumbnail_aspect());
+
+	const std::vector<Vertex> vertices = {
+		Vertex(glm::vec3(-0.5f * size.x, -0.5f * size.y, eps), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec4(0.0f, 0.0f, 0.0f, 0.0f), glm::vec2(first.x, last.y)),
+		Vertex(glm::vec3( 0.5f * size.x,  0.5f * size.y, eps), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec4(0.0f, 0.0f, 0.0f, 0.0f), glm::vec2(last.x, first.y)),
+		Vertex(glm::vec3(-0.5f * size.x,  0.5f * size.y, eps), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec4(0.0f, 0.0f, 0.0f, 0.0f), glm::vec2(first.x, first.y)),
+		Vertex(glm::vec3( 0.5f * size.x, -0.5f * size.y, eps), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec4(0.0f, 0.0f, 0.0f, 0.0f), glm::vec2(last.x, last.y)),
+	};
+
+	const std::vector<GLuint> indices = {
+		0, 1, 2,
+		0, 3, 1,
+	};
+
+	m_thumbnail.update_vertices(vertices, indices);
+
+	// move thumbnail above the pointed position
+	const glm::vec3 shift((frac - 0.5f) * bar_size.x, 0.5f * (bar_size.y + size.y), 0.0f);
+	m_thumbnail.set_transform(glm::translate(Panel::pose(), shift));
+
+	return true;
 }
 
 void ProgressBar::update_state(void)
 {
 	set_cursor_position();
+
+	/* the menu calls update_on_interaction() for the focused panel only, which shows the thumbnail again */
+	m_thumbnail_visible = false;
 }
 
+/** move the play position with the controller.
+ * Pointing at the progress bar previews the position with a thumbnail.
+ * While the trigger is held after pressing it on the bar, the picture follows the cursor from keyframe to keyframe,
+ * also when the ray leaves the bar, and the exact position is sought when the trigger is let go.
+ */
 bool ProgressBar::update_on_interaction(const intersection_t isec, const OpenVRInterface::input_state_t& input)
 {
+	const float frac = glm::clamp(isec.local.x, 0.0f, 1.0f);
+
 	if (input.trigger.button.released && isec.hit)
 	{
-		const float step = m_progress_max * isec.local.x - m_progress_pos;
-		player().jump(step);
+		m_dragging = true;
+	}
+
+	m_thumbnail_visible = (isec.hit || m_dragging) && show_thumbnail(frac);
+
+	if (m_dragging && input.trigger.button.pressed)
+	{
+		player().scrub(m_progress_max * frac);
+	}
+	else if (m_dragging && input.trigger.button.lifted)
+	{
+		m_dragging = false;
+		player().seek(m_progress_max * frac);
 	}
 
 	return input.trigger.button.released && isec.hit;
@@ -12,10 +12,14 @@ class ProgressBar : public Panel
 	private:
 		float m_progress_max;
 		float m_progress_pos;
+		bool m_dragging;
 		Shape m_cursor;
 		Texture m_cursor_tex;
+		Shape m_thumbnail;
+		bool m_thumbnail_visible;
 
 		void init_cursor(void);
+		bool show_thumbnail(const float frac);
 		void set_cursor_position(void);
 
 	public:
@@ -5,7 +5,13 @@
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
+#include <map>
+#include <mutex>
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
 #include "projection.h"
+#include "opengl/shader_set.h"
 
 /*
  * projection    tiling        angle        zoom        stretch        follow HMD
@@ -32,6 +38,11 @@
 
 static const glm::vec4 color_none(0.0f, 0.0f, 0.0f, 0.0f);
 static const float radius = 10.0f;      // minimum distance to screen
+static const float default_pixel_angle = 0.0015f;   // radians per pixel of a typical HMD eye render target
+static const float viewer_offset = 0.1f;            // eye separation and head movement around the projection center
+static const size_t min_details = 4;
+static const size_t max_details = 256;
+static const float texel_oversampling = 1.25f;      // texels per eye pixel, headroom for the filtering on the canvas
 
 /** constructor. */
 Projection::Projection(void) :
@@ -40,10 +51,11 @@ Projection::Projection(void) :
 	m_angle(glm::pi<float>()),
 	m_zoom(0.0f),
 	m_aspect(1.0f),
-	m_details(32),
+	m_pixel_angle(default_pixel_angle),
 	m_stretch(false),
 	m_switch_eyes(false),
-	m_mono(false)
+	m_mono(false),
+	m_raycast(false)
 {
 }
 
@@ -111,6 +123,23 @@ void Projection::set_mono(const bool m)
 	m_mono = m;
 }
 
+/** set the viewing angle covered by one pixel of the eye render target.
+ * The tessellation of curved projections is chosen to keep the geometric error below half a pixel.
+ * @param a angle per pixel given in radians.
+ */
+void Projection::set_pixel_angle(const float a)
+{
+	m_pixel_angle = a;
+}
+
+/** set the flag to ray cast the projection in the fragment shader.
+ * @param r flag to ray cast the projection instead of drawing the tessellated canvas.
+ */
+void Projection::set_raycast(const bool r)
+{
+	m_raycast = r;
+}
+
 /** flag for the target projection mode.
  * @return flag for the target projection mode.
  */
@@ -180,6 +209,25 @@ bool Projection::mono(void) const
 	return m_mono;
 }
 
+/** flag for ray casting the projection in the fragment shader.
+ * @return flag for ray casting the projection in the fragment shader.
+ */
+bool Projection::raycast(void) const
+{
+	return m_raycast;
+}
+
+/** flag for drawing the projection by ray casting.
+ * Cube maps are always ray cast, independent of the user setting,
+ * so they are sampled from the native cube map textures with seamless filtering.
+ * Equi-angular cube maps (EAC) also need the angular warp per fragment.
+ * @return flag for drawing the projection by ray casting.
+ */
+bool Projection::use_raycast(void) const
+{
+	return m_raycast || (m_projection == PROJECTION_CUBE_MAP);
+}
+
 /** map cursor coordinates into texture coordinates.
  * For stereoscopic mappings, the cursor must be mapped into the primary texture coordinates.
  */
@@ -189,6 +237,7 @@ void Projection::map_cursor(glm::vec2& mouse) const
 	{
 		case TILE_MONO:
 		case TILE_CUBE_MAP_MONO:
+		case TILE_EAC_MONO:
 			break;
 		case TILE_LEFT_RIGHT:
 		case TILE_CUBE_MAP_STEREO:
@@ -199,6 +248,7 @@ void Projection::map_cursor(glm::vec2& mouse) const
 			}
 			break;
 		case TILE_TOP_BOTTOM:
+		case TILE_EAC_STEREO:
 
 			if (mouse.y >= 0.5f)
 			{
@@ -267,6 +317,169 @@ std::pair<std::vector<Vertex>, std::vector<GLuint> > Projection::setup_projectio
 	return std::pair<std::vector<Vertex>, std::vector<GLuint> >(vertdata, indices);
 }
 
+/** create the triangle indices of a regular grid of vertices.
+ * The vertices are stored row by row, each row holding columns + 1 vertices,
+ * so neighbouring cells share their common vertices.
+ * The index lists only depend on the grid size and are cached.
+ * @param columns number of cells in horizontal direction.
+ * @param rows number of cells in vertical direction.
+ * @return indices for two triangles per grid cell.
+ */
+static std::vector<GLuint> grid_indices(const size_t columns, const size_t rows)
+{
+	static std::map<std::pair<size_t, size_t>, std::vector<GLuint> > cache;
+	static std::mutex cache_mutex;
+
+	std::lock_guard<std::mutex> lock(cache_mutex);
+	std::vector<GLuint>& indices = cache[std::make_pair(columns, rows)];
+
+	if (indices.empty())
+	{
+		const size_t stride = columns + 1;
+
+		indices.reserve(columns * rows * 6);
+
+		for (size_t row = 0; row < rows; row++)
+		{
+			for (size_t column = 0; column < columns; column++)
+			{
+				// 0--1 1
+				// | / /|
+				// |/ / |
+				// 2 2--3
+				const GLuint i0 = static_cast<GLuint>(row * stride + column);
+				const GLuint i1 = i0 + 1;
+				const GLuint i2 = static_cast<GLuint>((row + 1) * stride + column);
+				const GLuint i3 = i2 + 1;
+
+				indices.push_back(i0);
+				indices.push_back(i2);
+				indices.push_back(i1);
+				indices.push_back(i2);
+				indices.push_back(i3);
+				indices.push_back(i1);
+			}
+		}
+	}
+	return indices;
+}
+
+/** connect two rows of vertices with different numbers of segments.
+ * Both rows span the same range of texture coordinates with equally spaced vertices.
+ * The triangles advance along the row, whose next vertex comes first.
+ * @param indices list to append the triangle indices to.
+ * @param top index of the first vertex of the upper row.
+ * @param top_segments number of segments of the upper row.
+ * @param bottom index of the first vertex of the lower row.
+ * @param bottom_segments number of segments of the lower row.
+ */
+static void stitch_rows(std::vector<GLuint>& indices, const size_t top, const size_t top_segments, const size_t bottom, const size_t bottom_segments)
+{
+	size_t i = 0;
+	size_t j = 0;
+
+	while ((i < top_segments) || (j < bottom_segments))
+	{
+		/* compare the positions (i + 1) / top_segments and (j + 1) / bottom_segments */
+		if ((i < top_segments) && ((j == bottom_segments) || ((i + 1) * bottom_segments <= (j + 1) * top_segments)))
+		{
+			indices.push_back(static_cast<GLuint>(top + i));
+			indices.push_back(static_cast<GLuint>(bottom + j));
+			indices.push_back(static_cast<GLuint>(top + i + 1));
+			i++;
+		}
+		else
+		{
+			indices.push_back(static_cast<GLuint>(top + i));
+			indices.push_back(static_cast<GLuint>(bottom + j));
+			indices.push_back(static_cast<GLuint>(bottom + j + 1));
+			j++;
+		}
+	}
+}
+
+/** part of a stereoscopic source needed for forced monoscopic projection.
+ * Only the left or top view is shown, so the other half need not be rendered.
+ * @return fraction of the source width and height to keep, starting at the top left corner.
+ */
+glm::vec2 Projection::mono_crop(void) const
+{
+	if (!m_mono)
+	{
+		return glm::vec2(1.0f, 1.0f);
+	}
+
+	switch (m_tiling)
+	{
+		case TILE_LEFT_RIGHT:
+		case TILE_CUBE_MAP_STEREO:
+			return glm::vec2(0.5f, 1.0f);
+		case TILE_TOP_BOTTOM:
+		case TILE_EAC_STEREO:
+			return glm::vec2(1.0f, 0.5f);
+		default:
+			return glm::vec2(1.0f, 1.0f);
+	}
+}
+
+/** number of texels across the source texture, which the eye can resolve.
+ * The texel density is taken where it is highest, in the center of the canvas
+ * seen from the configured zoom, and compared to the angle of one pixel of the eye render target.
+ * Side by side tilings hold the span of one eye twice across the texture, unless cropped to one eye.
+ * @return texture width in texels.
+ */
+float Projection::texture_width(void) const
+{
+	const float distance = std::max(radius + m_zoom, viewer_offset);
+	float span = 0.0f;      // angle covered by the texture width of one eye
+
+	switch (m_projection)
+	{
+		case PROJECTION_FLAT:
+			span = 2.0f * tanf(0.25f * m_angle) * radius / distance;
+			break;
+		case PROJECTION_CYLINDER:
+		case PROJECTION_SPHERE:
+			span = m_angle * radius / distance;
+			break;
+		case PROJECTION_FISHEYE:
+			/* the equisolid mapping is densest in the center, where the texture width spans twice the focus */
+			span = 4.0f * sinf(0.25f * m_angle) * radius / distance;
+			break;
+		case PROJECTION_CUBE_MAP:
+			/* faces of a plain cube map are densest in their centers, EAC faces are uniform */
+			span = ((m_tiling == TILE_EAC_MONO) || (m_tiling == TILE_EAC_STEREO)) ? glm::half_pi<float>() : 2.0f;
+			span *= (m_tiling == TILE_CUBE_MAP_STEREO) ? 2.0f : 3.0f;
+			break;
+		default:
+			throw std::runtime_error("invalid projection");
+	}
+
+	if (((m_tiling == TILE_LEFT_RIGHT) || (m_tiling == TILE_CUBE_MAP_STEREO)) && !m_mono)
+	{
+		span *= 2.0f;
+	}
+	return texel_oversampling * span / m_pixel_angle;
+}
+
+/** number of segments to approximate an arc of the projection surface.
+ * A chord spanning the angle t deviates from the arc by the sagitta radius * t^2 / 8,
+ * which is visible as parallax for a viewer offset from the center.
+ * Additionally, the linear texture interpolation along the chord bends the image by about t^3 / 62.
+ * The segment angle keeps both errors below half a pixel of the eye render target.
+ * @param arc angle of the arc given in radians.
+ * @return number of segments.
+ */
+size_t Projection::details(const float arc) const
+{
+	const float error = 0.5f * m_pixel_angle;
+	const float offset = fabsf(m_zoom) + viewer_offset;
+	const float segment = std::min(cbrtf(62.0f * error), sqrtf(8.0f * error * radius / offset));
+	const size_t count = static_cast<size_t>(ceilf(fabsf(arc) / segment));
+
+	return std::min(std::max(count, min_details), max_details);
+}
+
 /** configure cylindrical projection.
  * The viewer is positioned at the center of a cylinder with a fixed radius.
  * The projection spans an arc of the configured angle.
@@ -279,45 +492,85 @@ std::pair<std::vector<Vertex>, std::vector<GLuint> > Projection::setup_projectio
 	const float angle_start = -m_angle / 2;
 	const float aspect = (m_stretch ? 1.0f : 0.5f) * m_aspect;
 	const float height = m_angle * radius / aspect;
+	const size_t columns = details(m_angle);
 
-	std::vector<Vertex> vertdata;
-	std::vector<GLuint> indices;
+	std::vector<Vertex> vertdata(2 * (columns + 1));
 
-	for (size_t column = 0; column < m_details; column++)
+	// 0--1--2-- ... --n
+	// |  |  |         |
+	// n+1 ...       2n+1
+	for (size_t column = 0; column <= columns; column++)
 	{
-		float t1 = (static_cast<float>(column) / static_cast<float>(m_details));
-		float t2 = (static_cast<float>(column + 1) / static_cast<float>(m_details));
-
-		float x1 = sinf(angle_start + t1 * m_angle) * radius;
-		float y1 = cosf(angle_start + t1 * m_angle) * radius;
-		float x2 = sinf(angle_start + t2 * m_angle) * radius;
-		float y2 = cosf(angle_start + t2 * m_angle) * radius;
-
-		// .   2    _n
-		// 1  /|  _/ |   _m
-		// | / |_/   | _/ |
-		// |/  2     n/   |
-		// 1              m
-		vertdata.push_back(Vertex(glm::vec3(x1,  height / 2, -m_zoom - y1), glm::vec3(0.0f, 0.0f, 0.0f), color_none, glm::vec2(t1, 0)));
-		vertdata.push_back(Vertex(glm::vec3(x2,  height / 2, -m_zoom - y2), glm::vec3(0.0f, 0.0f, 0.0f), color_none, glm::vec2(t2, 0)));
-		vertdata.push_back(Vertex(glm::vec3(x1, -height / 2, -m_zoom - y1), glm::vec3(0.0f, 0.0f, 0.0f), color_none, glm::vec2(t1, 1)));
-		vertdata.push_back(Vertex(glm::vec3(x2, -height / 2, -m_zoom - y2), glm::vec3(0.0f, 0.0f, 0.0f), color_none, glm::vec2(t2, 1)));
-
-		indices.push_back(static_cast<GLuint>(column * 4 + 0));
-		indices.push_back(static_cast<GLuint>(column * 4 + 2));
-		indices.push_back(static_cast<GLuint>(column * 4 + 1));
-		indices.push_back(static_cast<GLuint>(column * 4 + 2));
-		indices.push_back(static_cast<GLuint>(column * 4 + 3));
-		indices.push_back(static_cast<GLuint>(column * 4 + 1));
+		const float t = (static_cast<float>(column) / static_cast<float>(columns));
+
+		const float x = sinf(angle_start + t * m_angle) * radius;
+		const float y = cosf(angle_start + t * m_angle) * radius;
+
+		vertdata[column] = Vertex(glm::vec3(x,  height / 2, -m_zoom - y), glm::vec3(0.0f, 0.0f, 0.0f), color_none, glm::vec2(t, 0));
+		vertdata[columns + 1 + column] = Vertex(glm::vec3(x, -height / 2, -m_zoom - y), glm::vec3(0.0f, 0.0f, 0.0f), color_none, glm::vec2(t, 1));
 	}
 
-	return std::pair<std::vector<Vertex>, std::vector<GLuint> >(vertdata, indices);
+	return std::pair<std::vector<Vertex>, std::vector<GLuint> >(vertdata, grid_indices(columns, 1));
+}
+
+/** map a row of fisheye image positions onto the sphere.
+ * With s = r * focus and theta = 2 * arcsin(s), the angle doubling identities give
+ * cos(theta) = 1 - 2 * s^2 and sin(theta) = 2 * s * sqrt(1 - s^2).
+ * As s / r = focus, the horizontal position is x = radius * sin(theta) * tx / r
+ * = 2 * focus * radius * sqrt(1 - s^2) * tx, so no trigonometric functions and no
+ * division by the distance from the image center are needed, and four points are computed at once.
+ * @param tx horizontal image positions of the row in the range of -0.5 to 0.5.
+ * @param count number of positions.
+ * @param ty vertical image position of the row.
+ * @param focus scale from image distance to sine of half the viewing angle.
+ * @param x resulting x-coordinates.
+ * @param y resulting y-coordinates.
+ * @param z resulting distances in viewing direction.
+ */
+static void fisheye_row(const float* tx, const size_t count, const float ty, const float focus, float* x, float* y, float* z)
+{
+	size_t i = 0;
+
+#ifdef __SSE__
+	const __m128 v_ty2 = _mm_set1_ps(ty * ty);
+	const __m128 v_ty = _mm_set1_ps(ty);
+	const __m128 v_focus = _mm_set1_ps(focus);
+	const __m128 v_scale = _mm_set1_ps(2.0f * focus * radius);
+	const __m128 v_radius = _mm_set1_ps(radius);
+	const __m128 v_one = _mm_set1_ps(1.0f);
+	const __m128 v_two = _mm_set1_ps(2.0f);
+	const __m128 v_zero = _mm_setzero_ps();
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128 v_tx = _mm_loadu_ps(tx + i);
+		const __m128 v_tr = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(v_tx, v_tx), v_ty2));
+		const __m128 v_s = _mm_min_ps(_mm_mul_ps(v_tr, v_focus), v_one);
+		const __m128 v_s2 = _mm_mul_ps(v_s, v_s);
+		const __m128 v_k = _mm_mul_ps(v_scale, _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(v_one, v_s2), v_zero)));
+
+		_mm_storeu_ps(x + i, _mm_mul_ps(v_k, v_tx));
+		_mm_storeu_ps(y + i, _mm_sub_ps(v_zero, _mm_mul_ps(v_k, v_ty)));
+		_mm_storeu_ps(z + i, _mm_mul_ps(_mm_sub_ps(v_one, _mm_mul_ps(v_two, v_s2)), v_radius));
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		const float s = std::min(sqrtf(tx[i] * tx[i] + ty * ty) * focus, 1.0f);
+		const float k = 2.0f * focus * radius * sqrtf(std::max(1.0f - s * s, 0.0f));
+
+		x[i] = k * tx[i];
+		y[i] = -k * ty;         // negative sign for right handed coordinate system
+		z[i] = (1.0f - 2.0f * s * s) * radius;
+	}
 }
 
 /** configure spherical projection.
  * The viewer is positioned at the center of a sphere with a fixed radius.
  * The projection spans from the north pole to the south pole of the sphere.
  * In the longitudinal direction the projection covers an arc of the configured angle.
+ * The circles of latitude shrink towards the poles, so rows close to the poles get fewer columns.
  * For this projection, the aspect ratio always needs to be 1.
  * The zoom shifts the viewer position from the center of the sphere.
  * @return vertices and indices for a spherical projection.
@@ -325,71 +578,83 @@ std::pair<std::vector<Vertex>, std::vector<GLuint> > Projection::setup_projectio
 std::pair<std::vector<Vertex>, std::vector<GLuint> > Projection::setup_projection_sphere(void) const
 {
 	const float angle_start = -m_angle / 2;
+	const size_t rows = details(glm::pi<float>());
+	const size_t columns = details(m_angle);
+
+	/* sine and cosine of the latitude are shared by all vertices of a row */
+	std::vector<float> y_sin(rows + 1);
+	std::vector<float> y_cos(rows + 1);
+
+	for (size_t row = 0; row <= rows; row++)
+	{
+		const float t = static_cast<float>(row) / static_cast<float>(rows);
+
+		y_sin[row] = sinf(t * glm::pi<float>());    // distance from vertical middle axis
+		y_cos[row] = cosf(t * glm::pi<float>()) * radius;
+	}
 
-	std::vector<Vertex> vertdata;
+	/* columns per row, sized for the widest neighbouring row to keep adjacent triangles similar */
+	std::vector<size_t> row_columns(rows + 1);
+	std::vector<size_t> row_start(rows + 2, 0);
+
+	/* sine and cosine of the longitude, shared by all rows with the same number of columns */
+	std::map<size_t, std::vector<glm::vec2> > longitude;
+
+	for (size_t row = 0; row <= rows; row++)
+	{
+		const float width = std::max(y_sin[row], std::max(y_sin[(row > 0) ? (row - 1) : row], y_sin[std::min(row + 1, rows)]));
+
+		row_columns[row] = std::min(std::max(static_cast<size_t>(ceilf(width * static_cast<float>(columns))), static_cast<size_t>(1)), columns);
+		row_start[row + 1] = row_start[row] + row_columns[row] + 1;
+
+		std::vector<glm::vec2>& table = longitude[row_columns[row]];
+
+		if (table.empty())
+		{
+			table.resize(row_columns[row] + 1);
+
+			for (size_t column = 0; column <= row_columns[row]; column++)
+			{
+				const float tx = static_cast<float>(column) / static_cast<float>(row_columns[row]);
+
+				table[column] = glm::vec2(sinf(angle_start + tx * m_angle), cosf(angle_start + tx * m_angle)) * radius;
+			}
+		}
+	}
+
+	std::vector<Vertex> vertdata(row_start[rows + 1]);
 	std::vector<GLuint> indices;
 
-	for (size_t row = 0; row < m_details; row++)
+	for (size_t row = 0; row <= rows; row++)
 	{
-		for (size_t column = 0; column < m_details; column++)
+		const float ty = static_cast<float>(row) / static_cast<float>(rows);
+		const std::vector<glm::vec2>& table = longitude.find(row_columns[row])->second;
+
+		for (size_t column = 0; column <= row_columns[row]; column++)
 		{
-			const float tx1 = static_cast<float>(column) / static_cast<float>(m_details);
-			const float tx2 = static_cast<float>(column + 1) / static_cast<float>(m_details);
-			const float ty1 = static_cast<float>(row) / static_cast<float>(m_details);
-			const float ty2 = static_cast<float>(row + 1) / static_cast<float>(m_details);
-
-			const float y_sin1 = sinf(ty1 * glm::pi<float>()); // distance from vertical middle axis
-			const float y_sin2 = sinf(ty2 * glm::pi<float>());
-
-			float z1 = cosf(angle_start + tx1 * m_angle) * radius;           // z-position of vertices (front/back)
-			float z2 = cosf(angle_start + tx2 * m_angle) * radius;
-			float z3 = z1;
-			float z4 = z2;
-
-			z1 *= y_sin1;
-			z2 *= y_sin1;
-			z3 *= y_sin2;
-			z4 *= y_sin2;
-
-			float x1 = sinf(angle_start + tx1 * m_angle) * radius;
-			float x2 = sinf(angle_start + tx2 * m_angle) * radius;
-			float x3 = x1;
-			float x4 = x2;
-
-			x1 *= y_sin1;
-			x2 *= y_sin1;
-			x3 *= y_sin2;
-			x4 *= y_sin2;
-
-			const float y1 = cosf(ty1 * glm::pi<float>()) * radius;
-			const float y2 = y1;
-			const float y3 = cosf(ty2 * glm::pi<float>()) * radius;
-			const float y4 = y3;
-
-			// 0--1 1
-			// | / /|
-			// |/ / |
-			// 2 2--3
-			vertdata.push_back(Vertex(glm::vec3(x1, y1, -z1 - m_zoom), glm::vec3(0.0f, 0.0f, 0.0f), color_none, glm::vec2(tx1, ty1)));
-			vertdata.push_back(Vertex(glm::vec3(x2, y2, -z2 - m_zoom), glm::vec3(0.0f, 0.0f, 0.0f), color_none, glm::vec2(tx2, ty1)));
-			vertdata.push_back(Vertex(glm::vec3(x3, y3, -z3 - m_zoom), glm::vec3(0.0f, 0.0f, 0.0f), color_none, glm::vec2(tx1, ty2)));
-			vertdata.push_back(Vertex(glm::vec3(x4, y4, -z4 - m_zoom), glm::vec3(0.0f, 0.0f, 0.0f), color_none, glm::vec2(tx2, ty2)));
-
-			indices.push_back(static_cast<GLuint>((row * m_details + column) * 4 + 0));
-			indices.push_back(static_cast<GLuint>((row * m_details + column) * 4 + 2));
-			indices.push_back(static_cast<GLuint>((row * m_details + column) * 4 + 1));
-			indices.push_back(static_cast<GLuint>((row * m_details + column) * 4 + 2));
-			indices.push_back(static_cast<GLuint>((row * m_details + column) * 4 + 3));
-			indices.push_back(static_cast<GLuint>((row * m_details + column) * 4 + 1));
+			const float tx = static_cast<float>(column) / static_cast<float>(row_columns[row]);
+			const float x = table[column].x * y_sin[row];
+			const float z = table[column].y * y_sin[row];     // z-position of vertices (front/back)
+
+			vertdata[row_start[row] + column] = Vertex(glm::vec3(x, y_cos[row], -z - m_zoom), glm::vec3(0.0f, 0.0f, 0.0f), color_none, glm::vec2(tx, ty));
 		}
 	}
 
+	indices.reserve(3 * (row_start[rows + 1] - rows - 1) * 2);
+
+	for (size_t row = 1; row <= rows; row++)
+	{
+		stitch_rows(indices, row_start[row - 1], row_columns[row - 1], row_start[row], row_columns[row]);
+	}
+
 	return std::pair<std::vector<Vertex>, std::vector<GLuint> >(vertdata, indices);
 }
 
 /** configure fisheye projection.
  * The viewer is positioned at the center of a sphere with a fixed radius.
  * The projection spans an arc of the configured angle from the front viewing direction.
+ * The grid lines are placed at equal viewing angles instead of equal image distances,
+ * so the grid gets denser towards the edges of the image, where the lens compresses the view.
  * For this projection, the aspect ratio always needs to be 1.
  * The zoom shifts the viewer position from the center of the cylinder.
  * @return vertices and indices for a fisheye projection.
@@ -398,93 +663,58 @@ std::pair<std::vector<Vertex>, std::vector<GLuint> > Projection::setup_projectio
 {
 	const float angle_max = m_angle / 2.0f;
 	const float eps = std::numeric_limits<float>::epsilon();
+	const size_t count = details(m_angle);
+
+	/* note: projection angles from image center
+	 * r = 2 * f * sin(theta/2)
+	 * f = r / (2 * sin(theta/2))
+	 * . = 0.5 / (2 * sin(theta_max/2)))
+	 * . = 1 / (4 * sin(theta_max/2)))
+	 * theta = 2 * arcsin(r / (2*f))
+	 * .     = 2 * arcsin(r / (2*(1 / (4 * sin(theta_max/2)))))
+	 * .     = 2 * arcsin(r / (2 / (4 * sin(theta_max/2))))
+	 * .     = 2 * arcsin(r / (1 / (2 * sin(theta_max/2))))
+	 * .     = 2 * arcsin(r * 2 * sin(theta_max/2))
+	 */
+	const float focus = 2 * sinf(0.5f * angle_max);
+
+	/* image positions of the grid lines in the range of -0.5 to 0.5, at equal angular steps
+	 * r = sin(theta/2) / focus
+	 */
+	std::vector<float> position(count + 1);
+
+	for (size_t i = 0; i <= count; i++)
+	{
+		const float t = static_cast<float>(i) / static_cast<float>(count) - 0.5f;
 
-	std::vector<Vertex> vertdata;
-	std::vector<GLuint> indices;
+		position[i] = (focus < eps) ? t : (sinf(t * angle_max) / focus);
+	}
+
+	std::vector<Vertex> vertdata((count + 1) * (count + 1));
 
-	for (size_t row = 0; row < m_details; row++)
+	/* x: left-right
+	 * y: up-down
+	 * z: forward-backward
+	 */
+	std::vector<float> x(count + 1);
+	std::vector<float> y(count + 1);
+	std::vector<float> z(count + 1);
+
+	for (size_t row = 0; row <= count; row++)
 	{
-		for (size_t column = 0; column < m_details; column++)
+		const float ty = position[row];
+
+		fisheye_row(position.data(), count + 1, ty, focus, x.data(), y.data(), z.data());
+
+		for (size_t column = 0; column <= count; column++)
 		{
-			/* x: left-right
-			 * y: up-down
-			 * z: forward-backward
-			 */
-
-			/* (x,y) coordinates of four tile corners */
-			const float tx1 = static_cast<float>(column) / static_cast<float>(m_details) - 0.5f;
-			const float tx2 = static_cast<float>(column + 1) / static_cast<float>(m_details) - 0.5f;
-			const float ty1 = static_cast<float>(row) / static_cast<float>(m_details) - 0.5f;
-			const float ty2 = static_cast<float>(row + 1) / static_cast<float>(m_details) - 0.5f;
-
-			/* distances from image center */
-			const float tr1 = sqrtf(tx1 * tx1 + ty1 * ty1);
-			const float tr2 = sqrtf(tx2 * tx2 + ty1 * ty1);
-			const float tr3 = sqrtf(tx1 * tx1 + ty2 * ty2);
-			const float tr4 = sqrtf(tx2 * tx2 + ty2 * ty2);
-
-			/* note: projection angles from image center
-			 * r = 2 * f * sin(theta/2)
-			 * f = r / (2 * sin(theta/2))
-			 * . = 0.5 / (2 * sin(theta_max/2)))
-			 * . = 1 / (4 * sin(theta_max/2)))
-			 * theta = 2 * arcsin(r / (2*f))
-			 * .     = 2 * arcsin(r / (2*(1 / (4 * sin(theta_max/2)))))
-			 * .     = 2 * arcsin(r / (2 / (4 * sin(theta_max/2))))
-			 * .     = 2 * arcsin(r / (1 / (2 * sin(theta_max/2))))
-			 * .     = 2 * arcsin(r * 2 * sin(theta_max/2))
-			 */
-			const float focus = 2 * sinf(0.5f * angle_max);
-			const float angle_1 = 2 * asinf(std::min(tr1 * focus, 1.0f));
-			const float angle_2 = 2 * asinf(std::min(tr2 * focus, 1.0f));
-			const float angle_3 = 2 * asinf(std::min(tr3 * focus, 1.0f));
-			const float angle_4 = 2 * asinf(std::min(tr4 * focus, 1.0f));
-
-			const float z1 = cosf(angle_1) * radius;
-			const float z2 = cosf(angle_2) * radius;
-			const float z3 = cosf(angle_3) * radius;
-			const float z4 = cosf(angle_4) * radius;
-
-			const float r1 = sinf(angle_1) * radius;
-			const float r2 = sinf(angle_2) * radius;
-			const float r3 = sinf(angle_3) * radius;
-			const float r4 = sinf(angle_4) * radius;
-
-			// tan(azi) = dy1 / dx1
-			// tan(azi) = y1 / x1    ==>   y1 = tan(azi) * x1 = x1 * dy1 / dx1
-			// cos(azi) = dx1 / dr1
-			// cos(azi) = x1 / r1    ==>   x1 = r1 * cos(azi) = r1 * dx1 /dr1
-
-			const float x1 = ((tr1 < eps) ? 0.0f : (r1 * tx1 / tr1));
-			const float x2 = ((tr2 < eps) ? 0.0f : (r2 * tx2 / tr2));
-			const float x3 = ((tr3 < eps) ? 0.0f : (r3 * tx1 / tr3));
-			const float x4 = ((tr4 < eps) ? 0.0f : (r4 * tx2 / tr4));
-
-			/* negative sign for right handed coordinate system */
-			const float y1 = ((angle_1 < eps) ? 0.0f : ((fabsf(tx1) < eps) ? (-r1 * ty1 / fabsf(ty1)) : (-x1 * ty1 / tx1)));
-			const float y2 = ((angle_2 < eps) ? 0.0f : ((fabsf(tx2) < eps) ? (-r2 * ty1 / fabsf(ty1)) : (-x2 * ty1 / tx2)));
-			const float y3 = ((angle_3 < eps) ? 0.0f : ((fabsf(tx1) < eps) ? (-r3 * ty2 / fabsf(ty2)) : (-x3 * ty2 / tx1)));
-			const float y4 = ((angle_4 < eps) ? 0.0f : ((fabsf(tx2) < eps) ? (-r4 * ty2 / fabsf(ty2)) : (-x4 * ty2 / tx2)));
-
-			// 0--1 1
-			// | / /|
-			// |/ / |
-			// 2 2--3
-			vertdata.push_back(Vertex(glm::vec3(x1, y1, -z1 - m_zoom), glm::vec3(0.0f, 0.0f, 0.0f), color_none, glm::vec2(0.5f + tx1, ty1 + 0.5f)));
-			vertdata.push_back(Vertex(glm::vec3(x2, y2, -z2 - m_zoom), glm::vec3(0.0f, 0.0f, 0.0f), color_none, glm::vec2(0.5f + tx2, ty1 + 0.5f)));
-			vertdata.push_back(Vertex(glm::vec3(x3, y3, -z3 - m_zoom), glm::vec3(0.0f, 0.0f, 0.0f), color_none, glm::vec2(0.5f + tx1, ty2 + 0.5f)));
-			vertdata.push_back(Vertex(glm::vec3(x4, y4, -z4 - m_zoom), glm::vec3(0.0f, 0.0f, 0.0f), color_none, glm::vec2(0.5f + tx2, ty2 + 0.5f)));
-
-			indices.push_back(static_cast<GLuint>((row * m_details + column) * 4 + 0));
-			indices.push_back(static_cast<GLuint>((row * m_details + column) * 4 + 2));
-			indices.push_back(static_cast<GLuint>((row * m_details + column) * 4 + 1));
-			indices.push_back(static_cast<GLuint>((row * m_details + column) * 4 + 2));
-			indices.push_back(static_cast<GLuint>((row * m_details + column) * 4 + 3));
-			indices.push_back(static_cast<GLuint>((row * m_details + column) * 4 + 1));
+			const float tx = position[column];
+
+			vertdata[row * (count + 1) + column] = Vertex(glm::vec3(x[column], y[column], -z[column] - m_zoom), glm::vec3(0.0f, 0.0f, 0.0f), color_none, glm::vec2(0.5f + tx, ty + 0.5f));
 		}
 	}
 
-	return std::pair<std::vector<Vertex>, std::vector<GLuint> >(vertdata, indices);
+	return std::pair<std::vector<Vertex>, std::vector<GLuint> >(vertdata, grid_indices(count, count));
 }
 
 /** configure monoscopic cubemap projection.
@@ -592,6 +822,37 @@ std::pair<std::vector<Vertex>, std::vector<GLuint> > Projection::setup_projectio
 	return std::pair<std::vector<Vertex>, std::vector<GLuint> >(vertdata, indices);
 }
 
+/** identify the mesh of the current settings.
+ * Only the settings used by the configured projection are part of the key,
+ * angle, zoom and aspect ratio are quantised to 1/1000.
+ * @return key, which is equal for settings resulting in the same mesh.
+ */
+std::string Projection::mesh_key(void) const
+{
+	const float aspect = (m_stretch ? 1.0f : 0.5f) * m_aspect;
+	std::ostringstream key;
+
+	key << m_projection << ":" << lroundf(m_pixel_angle * 1.0e6f);
+
+	switch (m_projection)
+	{
+		case PROJECTION_FLAT:
+		case PROJECTION_CYLINDER:
+			key << ":" << lroundf(m_angle * 1000.0f) << ":" << lroundf(m_zoom * 1000.0f) << ":" << lroundf(aspect * 1000.0f);
+			break;
+		case PROJECTION_SPHERE:
+		case PROJECTION_FISHEYE:
+			key << ":" << lroundf(m_angle * 1000.0f) << ":" << lroundf(m_zoom * 1000.0f);
+			break;
+		case PROJECTION_CUBE_MAP:
+			key << ":" << m_tiling;
+			break;
+		default:
+			throw std::runtime_error("invalid projection");
+	}
+	return key.str();
+}
+
 /** configure projection.
  * generate the projection setup for the configured type of projection.
  * @return vertices and indices for a monoscopic cubemap projection.
@@ -630,3 +891,39 @@ std::pair<std::vector<Vertex>, std::vector<GLuint> > Projection::setup_projectio
 	}
 	return vertdata;
 }
+
+/** configure the ray casting shader for the current projection.
+ * Instead of a tessellated canvas, the fragment shader intersects the view ray
+ * with the exact projection surface, so all parameters are passed as uniforms.
+ * The surfaces match the geometry of the tessellated canvases.
+ * @param shader ray casting shader to configure.
+ */
+void Projection::setup_raycast(const ShaderSet& shader) const
+{
+	const float aspect = (m_stretch ? 1.0f : 0.5f) * m_aspect;
+	glm::vec2 screen_size(0.0f, 0.0f);
+
+	switch (m_projection)
+	{
+		case PROJECTION_FLAT:
+			screen_size.x = tanf(0.25f * m_angle) * radius;
+			screen_size.y = screen_size.x / aspect;
+			break;
+		case PROJECTION_CYLINDER:
+			screen_size.y = m_angle * radius / aspect;
+			break;
+		case PROJECTION_SPHERE:
+		case PROJECTION_FISHEYE:
+		case PROJECTION_CUBE_MAP:
+			break;
+		default:
+			throw std::runtime_error("invalid projection");
+	}
+
+	shader.set_uniform("projection", static_cast<int>(m_projection));
+	shader.set_uniform("angle", m_angle);
+	shader.set_uniform("zoom", m_zoom);
+	shader.set_uniform("radius", radius);
+	shader.set_uniform("focus", 2 * sinf(0.25f * m_angle));
+	shader.set_uniform("screen_size", screen_size);
+}
@@ -6,10 +6,13 @@
 #define PROJECTION_H
 
 #include <vector>
+#include <string>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "opengl/vertex.h"
 
+class ShaderSet;
+
 class Projection
 {
 	public:
@@ -20,6 +23,8 @@ class Projection
 			TILE_TOP_BOTTOM,
 			TILE_CUBE_MAP_MONO,
 			TILE_CUBE_MAP_STEREO,
+			TILE_EAC_MONO,          /* equi-angular cube map, 3x2 faces */
+			TILE_EAC_STEREO,        /* equi-angular cube map, 3x2 faces per eye, top/bottom */
 			NUM_TILINGS
 		}
 		video_tiling_t;
@@ -45,6 +50,8 @@ class Projection
 		void set_stretch(const bool s);
 		void set_switch_eyes(const bool e);
 		void set_mono(const bool m);
+		void set_pixel_angle(const float a);
+		void set_raycast(const bool r);
 
 		video_projection_t projection(void) const;
 		video_tiling_t tiling(void) const;
@@ -53,12 +60,18 @@ class Projection
 		bool stretch(void) const;
 		bool switch_eyes(void) const;
 		bool mono(void) const;
+		bool raycast(void) const;
+		bool use_raycast(void) const;
 
 		bool follow_hmd(void) const;
 		void map_cursor(glm::vec2& mouse) const;
 		glm::vec2 unit_scale(void) const;
+		glm::vec2 mono_crop(void) const;
+		float texture_width(void) const;
 
+		std::string mesh_key(void) const;
 		std::pair<std::vector<Vertex>, std::vector<GLuint> > setup_projection(void) const;
+		void setup_raycast(const ShaderSet& shader) const;
 
 	private:
 		video_projection_t m_projection;
@@ -66,11 +79,13 @@ class Projection
 		float m_angle;
 		float m_zoom;
 		float m_aspect;
-		size_t m_details;
+		float m_pixel_angle;
 		bool m_stretch;
 		bool m_switch_eyes;
 		bool m_mono;
+		bool m_raycast;
 
+		size_t details(const float arc) const;
 		std::pair<std::vector<Vertex>, std::vector<GLuint> > setup_projection_flat(void) const;
 		std::pair<std::vector<Vertex>, std::vector<GLuint> > setup_projection_cylinder(void) const;
 		std::pair<std::vector<Vertex>, std::vector<GLuint> > setup_projection_sphere(void) const;
@@ -0,0 +1,137 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "projection_worker.h"
+#include <iostream>
+
+ProjectionWorker::ProjectionWorker(void) :
+	m_request(),
+	m_result(),
+	m_result_key(),
+	m_generation(0),
+	m_result_generation(0),
+	m_requested(false),
+	m_ready(false),
+	m_running(false),
+	m_thread(),
+	m_mutex(),
+	m_cv()
+{
+}
+
+ProjectionWorker::~ProjectionWorker(void)
+{
+	stop();
+}
+
+void ProjectionWorker::start(void)
+{
+	if (!m_thread.joinable())
+	{
+		m_running = true;
+		m_thread = std::thread(&ProjectionWorker::worker_thread, this);
+	}
+}
+
+void ProjectionWorker::stop(void)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_running = false;
+	}
+	m_cv.notify_all();
+
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+}
+
+/** request a new mesh for the given projection settings.
+ * Requests not yet started are replaced, e.g. while dragging a slider
+ * only the latest position is computed.
+ * @param projection projection settings, copied for the worker.
+ */
+void ProjectionWorker::request(const Projection& projection)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_request = projection;
+		m_requested = true;
+		m_generation++;
+	}
+	m_cv.notify_all();
+}
+
+/** take the latest finished mesh, without waiting.
+ * A mesh of a request that was superseded in the meantime is dropped.
+ * @param key mesh key of the projection settings the mesh was generated for.
+ * @param mesh vertices and indices of the mesh.
+ * @return flag, whether a new mesh was available.
+ */
+bool ProjectionWorker::fetch(std::string& key, std::pair<std::vector<Vertex>, std::vector<GLuint> >& mesh)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (!m_ready)
+	{
+		return false;
+	}
+
+	m_ready = false;
+
+	if (m_result_generation != m_generation)
+	{
+		return false;
+	}
+
+	key = m_result_key;
+	mesh.first.swap(m_result.first);
+	mesh.second.swap(m_result.second);
+	return true;
+}
+
+void ProjectionWorker::worker_thread(void)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	size_t triangles = 0;
+
+	while (true)
+	{
+		m_cv.wait(lock, [this]{
+			return m_requested || !m_running;
+		});
+
+		if (!m_running)
+		{
+			break;
+		}
+
+		const Projection projection = m_request;
+		const uint64_t generation = m_generation;
+		m_requested = false;
+
+		lock.unlock();
+		std::pair<std::vector<Vertex>, std::vector<GLuint> > mesh = projection.setup_projection();
+
+		if (mesh.second.size() / 3 != triangles)
+		{
+			triangles = mesh.second.size() / 3;
+			std::cout << "projection mesh: " << mesh.first.size() << " vertices, " << triangles << " triangles" << std::endl;
+		}
+		lock.lock();
+
+		/* the mesh of a superseded request would only be uploaded to be evicted */
+		if (generation != m_generation)
+		{
+			continue;
+		}
+
+		m_result_key = projection.mesh_key();
+		m_result_generation = generation;
+		m_result.first.swap(mesh.first);
+		m_result.second.swap(mesh.second);
+		m_ready = true;
+	}
+}
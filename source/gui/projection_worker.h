@@ -0,0 +1,43 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef PROJECTION_WORKER_H
+#define PROJECTION_WORKER_H
+
+#include "projection.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+class ProjectionWorker
+{
+	private:
+		Projection m_request;
+		std::pair<std::vector<Vertex>, std::vector<GLuint> > m_result;
+		std::string m_result_key;
+		uint64_t m_generation;                  /* number of the latest request */
+		uint64_t m_result_generation;           /* number of the request the result was computed for */
+		bool m_requested;
+		bool m_ready;
+		bool m_running;
+		std::thread m_thread;
+		std::mutex m_mutex;
+		std::condition_variable m_cv;
+
+		ProjectionWorker(const ProjectionWorker&);
+		ProjectionWorker& operator=(const ProjectionWorker&);
+
+		void worker_thread(void);
+
+	public:
+		explicit ProjectionWorker(void);
+		~ProjectionWorker(void);
+
+		void start(void);
+		void stop(void);
+		void request(const Projection& projection);
+		bool fetch(std::string& key, std::pair<std::vector<Vertex>, std::vector<GLuint> >& mesh);
+};
+
+#endif
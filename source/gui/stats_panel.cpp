@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "stats_panel.h"
+#include "main.h"
+#include <sstream>
+#include <iomanip>
+
+static const glm::vec4 panel_color(0.5f, 0.4f, 0.2f, 0.8f);
+static const size_t texture_width = 300;
+static const size_t line_height = 20;
+static const size_t stats_lines = 8;
+static const float panel_width = 3.0f;
+
+/* interval of updating the shown statistics */
+static const std::chrono::milliseconds update_interval(1000);
+
+StatsPanel::StatsPanel(const action_t action) :
+	Panel(action),
+	m_updated()
+{
+	const glm::uvec2 tex_size(texture_width, stats_lines * line_height);
+	const glm::vec2 shape_size(panel_width, panel_width * static_cast<float>(tex_size.y) / static_cast<float>(tex_size.x));
+
+	init_area(shape_size, panel_color, tex_size);
+	render_stats();
+}
+
+StatsPanel::~StatsPanel(void)
+{
+}
+
+void StatsPanel::update_state(void)
+{
+	if (std::chrono::steady_clock::now() - m_updated >= update_interval)
+	{
+		render_stats();
+	}
+}
+
+/** write the current playback statistics into the panel.
+ */
+void StatsPanel::render_stats(void)
+{
+	const Player::stats_t s = player().stats();
+	std::ostringstream lines[stats_lines];
+
+	lines[0] << std::fixed << std::setprecision(3) << "video: " << s.fps << " fps, hwdec " << s.hwdec;
+	lines[1] << "dropped: " << s.frame_drops << " output, " << s.decoder_drops << " decoder";
+	lines[2] << "delayed: " << s.delayed_frames << " frames";
+	lines[3] << std::fixed << std::setprecision(1) << "a/v sync: " << (1000.0 * s.avsync) << " ms";
+	lines[4] << std::fixed << std::setprecision(1) << "cache: " << s.cache_duration << " s, " << (100.0f * s.cache_fill)
+	         << " % of " << (s.cache_limit / (1024 * 1024)) << " MiB";
+	lines[5] << std::fixed << std::setprecision(2) << "render: " << s.render_time << " ms";
+	lines[6] << std::fixed << std::setprecision(1) << "judder: " << (100.0f * s.judder) << " %";
+	lines[7] << std::fixed << std::setprecision(2) << "canvas: " << canvas_gpu_time() << " ms GPU per eye, " << (projection().use_raycast() ? "raycast" : "mesh");
+
+	Panel::clear();
+
+	for (size_t i = 0; i < stats_lines; i++)
+	{
+		Panel::text(lines[i].str(), 0, static_cast<int32_t>(i * line_height));
+	}
+	m_updated = std::chrono::steady_clock::now();
+}
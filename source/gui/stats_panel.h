@@ -0,0 +1,25 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef STATS_PANEL_H
+#define STATS_PANEL_H
+
+#include "panel.h"
+#include <chrono>
+
+class StatsPanel : public Panel
+{
+	private:
+		std::chrono::steady_clock::time_point m_updated;
+
+		void render_stats(void);
+
+	public:
+		explicit StatsPanel(const action_t action);
+		~StatsPanel(void) override;
+
+		void update_state(void) override;
+};
+
+#endif
@@ -7,6 +7,7 @@
 #include <iostream>
 #include <vector>
 #include <unistd.h>
+#include <stdlib.h>
 
 #include <GLFW/glfw3.h>
 
@@ -17,9 +18,16 @@
 #include "util/enum_iterator.h"
 #include "opengl/shape.h"
 #include "opengl/texture.h"
+#include "opengl/cube_map.h"
+#include "opengl/gpu_timer.h"
 #include "gui/controller.h"
 #include "gui/menu.h"
+#include "gui/projection_worker.h"
+#include "gui/mesh_cache.h"
 #include "util/file_system.h"
+#include "util/async_reader.h"
+#include "util/directory_index.h"
+#include "util/media_library.h"
 
 typedef enum
 {
@@ -35,18 +43,32 @@ static bool g_Running = true;
 static GLFWwindow* g_window = nullptr;
 static OpenVRInterface g_vr;
 static ShaderSet g_shaders;
+static ShaderSet g_raycast_shaders;
+static ShaderSet g_cube_shaders;
 static std::map<vr::TrackedDeviceIndex_t, Controller> g_controller;
 static std::vector<Framebuffer> g_framebuffer(Eyes::size());
 static Menu g_menu;
 static Projection g_projection;
-static Shape g_canvas;
+static ProjectionWorker g_projection_worker;
+static MeshCache g_mesh_cache;
+static Shape g_raycast_quad;
+static GpuTimer g_canvas_timer;              // GPU time of drawing the canvas for one eye
+static bool g_canvas_raycast = false;        // canvas path measured by the timer
+static glm::mat4 g_canvas_transform(1.0f);
+static std::vector<CubeMap> g_cube_map(Eyes::size());
+static bool g_cube_dirty = true;
+static size_t g_cube_frame = 0;
 static Texture g_image;
 static glm::vec3 g_hmd_reference_pos;
 static glm::quat g_hmd_reference_rot;
 static std::string g_current_file_name = "";
+static int32_t g_file_step = 1;              // direction of the last step through the directory
 static const float g_jump_step = 10.0f;      // seconds
 static source_t g_source = SOURCE_NONE;
 static Player g_player;
+static AsyncReader g_reader;
+static DirectoryIndex g_directory_index;
+static MediaLibrary g_library;
 static glm::uvec2 g_window_size(800, 600);
 
 static void framebuffer_size_callback(GLFWwindow* window __attribute__((unused)), int width, int height)
@@ -66,41 +88,43 @@ static std::string make_absolute(const std::string& relative)
 }
 
 static std::string file_step(const int32_t step)
+{
+	return g_directory_index.step(g_current_file_name, step);
+}
+
+/** read the images next to the current file in the background,
+ * so stepping through a directory does not wait for the disk.
+ * The next video in stepping direction is preloaded by the player.
+ */
+static void prefetch_neighbours(void)
 {
 	FileSystem fs;
-	std::vector<std::string> path = fs.split_path(g_current_file_name);
-	const std::string current_dir = fs.join_path(path.begin(), path.end() - 1);
-	const std::string current_file = path[path.size() - 1];
-	std::set<std::string> files = fs.file_names(current_dir);
-	std::set<std::string>::const_iterator iter = files.find(current_file);
+	std::vector<std::string> neighbours;
+	std::string archive;
+	std::string member;
 
-	if (iter == files.end())
+	for (const int32_t step : {1, -1})
 	{
-		return g_current_file_name;
-	}
+		const std::string file_name = file_step(step);
 
-	if ((step < 0) && (iter == files.begin()))
-	{
-		return g_current_file_name;
+		/* archive members are decompressed on demand and not read as a whole */
+		if ((file_name != g_current_file_name) && fs.is_image(fs.extension(file_name)) &&
+		    !fs.split_archive_path(file_name, archive, member))
+		{
+			neighbours.push_back(file_name);
+		}
 	}
+	g_reader.prefetch(neighbours);
 
-	if (step > 0)
+	if (g_source == SOURCE_VIDEO)
 	{
-		iter++;
-	}
-	else if (step < 0)
-	{
-		iter--;
-	}
+		const std::string file_name = file_step(g_file_step);
 
-	if (iter == files.end())
-	{
-		return g_current_file_name;
+		if ((file_name != g_current_file_name) && fs.is_video(fs.extension(file_name)))
+		{
+			g_player.preload(file_name);
+		}
 	}
-
-	path[path.size() - 1] = *iter;
-
-	return fs.join_path(path.begin(), path.end());
 }
 
 void quit(void)
@@ -133,6 +157,7 @@ void player_previous(void)
 {
 	const std::string file_name = file_step(-1);
 
+	g_file_step = -1;
 	player_open_file(file_name);
 }
 
@@ -140,6 +165,7 @@ void player_next(void)
 {
 	const std::string file_name = file_step(1);
 
+	g_file_step = 1;
 	player_open_file(file_name);
 }
 
@@ -152,7 +178,10 @@ void player_open_file(const std::string& file_name)
 	{
 		// g_player.stop();
 		// g_player.close();
-		const glm::uvec2 image_size = g_image.init_image_file(file_name, 0);
+		std::vector<uint8_t> data;
+		const glm::uvec2 image_size = g_reader.fetch(file_name, data, true) ?
+		                              g_image.init_image(ImageFile(file_name, data), 0) :
+		                              g_image.init_image_file(file_name, 0);
 		const float aspect = static_cast<float>(image_size.x) / static_cast<float>(image_size.y);
 		g_image.unbind();
 		g_projection.set_aspect(aspect);
@@ -167,6 +196,8 @@ void player_open_file(const std::string& file_name)
 		g_source = SOURCE_VIDEO;
 	}
 	g_current_file_name = file_name;
+	g_cube_dirty = true;
+	prefetch_neighbours();
 }
 
 void player_show_desktop(void)
@@ -178,16 +209,48 @@ Player& player(void)
 	return g_player;
 }
 
+/** media library of the home directory.
+ * The crawl is started, when the library is used for the first time.
+ * @return media library.
+ */
+MediaLibrary& library(void)
+{
+	if (!g_library.started() && getenv("HOME"))
+	{
+		g_library.start({getenv("HOME")}, MediaLibrary::default_index_file());
+	}
+	return g_library;
+}
+
 Projection& projection(void)
 {
 	return g_projection;
 }
 
+/** GPU time of drawing the canvas with the current render path.
+ * @return smoothed time per eye in milliseconds.
+ */
+float canvas_gpu_time(void)
+{
+	return g_canvas_timer.time();
+}
+
+/** show the canvas for the current projection settings.
+ * Recently used meshes are taken from the cache, others are computed in the background.
+ * The main loop swaps in the new mesh, when it is ready.
+ * A ray casted projection takes its parameters from uniforms and needs no mesh.
+ * The video is rendered at the texture resolution, which the projection can resolve.
+ */
 void update_projection(void)
 {
-	std::pair<std::vector<Vertex>, std::vector<GLuint> > proj = g_projection.setup_projection();
+	g_cube_dirty = true;
+	g_player.set_crop(g_projection.mono_crop());
+	g_player.set_texture_width(g_projection.texture_width());
 
-	g_canvas.init_vertices(proj.first, proj.second);
+	if (!g_projection.use_raycast() && !g_mesh_cache.select(g_projection.mesh_key()))
+	{
+		g_projection_worker.request(g_projection);
+	}
 }
 
 ShaderSet& shader(void)
@@ -203,12 +266,27 @@ static void reset_reference(void)
 	g_hmd_reference_rot = glm::quat_cast(hmd_pose);
 }
 
+/** flag for a video cropped to one view.
+ * For forced monoscopic projection, mpv renders only the view shown,
+ * which then fills the whole video texture.
+ * @return flag, whether the video texture holds one view only.
+ */
+static bool video_cropped(void)
+{
+	return (g_source == SOURCE_VIDEO) && (g_projection.mono_crop() != glm::vec2(1.0f, 1.0f));
+}
+
 static void setup_shader(ShaderSet& shader, const vr::Hmd_Eye eye)
 {
 	glm::vec2 offset;
 	glm::vec2 scale;
 
-	if (g_projection.mono() ||
+	if (video_cropped())
+	{
+		offset = glm::vec2(0.0f, 0.0f);
+		scale  = glm::vec2(1.0f, 1.0f);
+	}
+	else if (g_projection.mono() ||
 	    (!g_projection.switch_eyes() && (eye == vr::Eye_Left)) ||
 	    (g_projection.switch_eyes() && (eye == vr::Eye_Right)))
 	{
@@ -220,11 +298,13 @@ static void setup_shader(ShaderSet& shader, const vr::Hmd_Eye eye)
 				scale  = glm::vec2(0.5f, 1.0f);
 				break;
 			case Projection::TILE_TOP_BOTTOM:
+			case Projection::TILE_EAC_STEREO:
 				offset = glm::vec2(0.0f, 0.0f);
 				scale  = glm::vec2(1.0f, 0.5f);
 				break;
 			case Projection::TILE_MONO:
 			case Projection::TILE_CUBE_MAP_MONO:
+			case Projection::TILE_EAC_MONO:
 				offset = glm::vec2(0.0f, 0.0f);
 				scale  = glm::vec2(1.0f, 1.0f);
 				break;
@@ -244,12 +324,14 @@ static void setup_shader(ShaderSet& shader, const vr::Hmd_Eye eye)
 				// mouse.x += offset.x;
 				break;
 			case Projection::TILE_TOP_BOTTOM:
+			case Projection::TILE_EAC_STEREO:
 				offset = glm::vec2(0.0f, 0.5f);
 				scale  = glm::vec2(1.0f, 0.5f);
 				// mouse.y += offset.y;
 				break;
 			case Projection::TILE_MONO:
 			case Projection::TILE_CUBE_MAP_MONO:
+			case Projection::TILE_EAC_MONO:
 				offset = glm::vec2(0.0f, 0.0f);
 				scale  = glm::vec2(1.0f, 1.0f);
 				break;
@@ -288,7 +370,127 @@ static void setup_hmd(const glm::mat4& hmdPose)
 	}
 	reference *= mat4_cast(g_hmd_reference_rot);
 
-	g_canvas.set_transform(reference);
+	g_mesh_cache.set_transform(reference);
+	g_canvas_transform = reference;
+}
+
+/** repack a cube map source into native cube map textures.
+ * This is done once for a new image or video frame, or after the projection settings changed.
+ * Stereoscopic sources get one cube map per eye.
+ */
+static void update_cube_maps(void)
+{
+	if ((g_source == SOURCE_VIDEO) && (g_player.frames() != g_cube_frame))
+	{
+		g_cube_dirty = true;
+	}
+
+	if (!g_cube_dirty || (g_source == SOURCE_NONE))
+	{
+		return;
+	}
+
+	const glm::uvec2 source_size = (g_source == SOURCE_IMAGE) ? g_image.size() : g_player.render_size();
+	const bool cube_stereo = (g_projection.tiling() == Projection::TILE_CUBE_MAP_STEREO);
+	const bool eac = (g_projection.tiling() == Projection::TILE_EAC_MONO) || (g_projection.tiling() == Projection::TILE_EAC_STEREO);
+	const bool eac_stereo = (g_projection.tiling() == Projection::TILE_EAC_STEREO);
+	const bool stereo = (cube_stereo || eac_stereo) && !g_projection.mono();
+	glm::uvec2 region = source_size;
+
+	/* stereoscopic cube maps hold one view per half, stereoscopic EAC sources stack two views */
+	if (!video_cropped())
+	{
+		region.x /= cube_stereo ? 2 : 1;
+		region.y /= eac_stereo ? 2 : 1;
+	}
+
+	/* the faces of a view are arranged in 3x2 tiles, or in 2x3 tiles for stereoscopic cube maps */
+	const GLuint face_size = cube_stereo ? std::min(region.x / 2, region.y / 3) : std::min(region.x / 3, region.y / 2);
+
+	if (face_size == 0)
+	{
+		return;
+	}
+
+	if (g_source == SOURCE_IMAGE)
+	{
+		g_image.bind();
+	}
+	else
+	{
+		g_player.bind();
+	}
+	glDisable(GL_BLEND);
+
+	for (vr::Hmd_Eye eye : Eyes())
+	{
+		if (!stereo && (eye != vr::Eye_Left))
+		{
+			break;
+		}
+
+		setup_shader(g_cube_shaders, eye);
+		g_cube_shaders.set_uniform("cube_stereo", cube_stereo);
+		g_cube_shaders.set_uniform("eac", eac);
+		g_cube_map[eye].init(face_size, 1);
+		g_cube_map[eye].repack(g_cube_shaders, g_raycast_quad);
+	}
+
+	glEnable(GL_BLEND);
+	g_cube_shaders.deactivate();
+
+	if (g_source == SOURCE_IMAGE)
+	{
+		g_image.unbind();
+	}
+	else
+	{
+		g_player.unbind();
+	}
+
+	g_cube_frame = g_player.frames();
+	g_cube_dirty = false;
+}
+
+/** draw the canvas for one eye.
+ * In ray casting mode, a full screen quad is drawn and the fragment shader
+ * maps every view ray to the source texture.
+ * @param eye eye to render.
+ */
+static void draw_canvas(const vr::Hmd_Eye eye)
+{
+	g_canvas_timer.begin();
+
+	if (!g_projection.use_raycast())
+	{
+		g_mesh_cache.draw();
+		g_canvas_timer.end();
+		return;
+	}
+
+	const glm::mat4 projview = g_vr.projection(eye) * g_vr.view(eye);
+
+	setup_shader(g_raycast_shaders, eye);
+	g_raycast_shaders.set_uniform("greyscale", false);
+	g_raycast_shaders.set_uniform("model", g_canvas_transform);
+	g_raycast_shaders.set_uniform("inverse_transform", glm::inverse(projview * g_canvas_transform));
+	g_projection.setup_raycast(g_raycast_shaders);
+
+	if (g_projection.projection() == Projection::PROJECTION_CUBE_MAP)
+	{
+		const bool stereo = ((g_projection.tiling() == Projection::TILE_CUBE_MAP_STEREO) || (g_projection.tiling() == Projection::TILE_EAC_STEREO)) && !g_projection.mono();
+		const CubeMap& cube = g_cube_map[stereo ? eye : vr::Eye_Left];
+
+		cube.bind();
+		g_raycast_quad.draw();
+		cube.unbind();
+	}
+	else
+	{
+		g_raycast_quad.draw();
+	}
+	g_canvas_timer.end();
+	g_shaders.activate();
 }
 
 int main(void)
@@ -322,31 +524,64 @@ int main(void)
 	glEnable(GL_CULL_FACE);
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
 
 	for (std::vector<Framebuffer>::iterator iter = g_framebuffer.begin(); iter != g_framebuffer.end(); ++iter)
 	{
 		iter->init(render_size);
 	}
 
+	/* horizontal field of view per pixel of the eye render target, used for the tessellation */
+	const glm::mat4 eye_projection = g_vr.projection(vr::Eye_Left);
+	g_projection.set_pixel_angle(2.0f * atanf(1.0f / eye_projection[0][0]) / static_cast<float>(render_size.x));
+
 	// create shaders & geometry
 	g_shaders.load_shaders("shaders/scene.vertex.glsl", "shaders/scene.fragment.glsl");
 	g_shaders.set_uniform("background", false);
 	g_shaders.set_uniform("greyscale", false);
-
+	g_raycast_shaders.load_shaders("shaders/raycast.vertex.glsl", "shaders/raycast.fragment.glsl");
+	g_raycast_shaders.set_uniform("greyscale", false);
+	g_raycast_shaders.set_uniform("cube0", 1);
+	g_cube_shaders.load_shaders("shaders/cubemap.vertex.glsl", "shaders/cubemap.fragment.glsl");
+	g_raycast_quad.init_vertices({
+		Vertex(glm::vec3(-1.0f,  1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec4(0.0f), glm::vec2(0.0f, 0.0f)),
+		Vertex(glm::vec3( 1.0f,  1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec4(0.0f), glm::vec2(1.0f, 0.0f)),
+		Vertex(glm::vec3(-1.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec4(0.0f), glm::vec2(0.0f, 1.0f)),
+		Vertex(glm::vec3( 1.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec4(0.0f), glm::vec2(1.0f, 1.0f))
+	}, {
+		0, 2, 1,
+		2, 3, 1
+	});
+
+	g_canvas_timer.init(8);
 	g_menu.init();
+	g_projection_worker.start();
+	g_reader.start();
 
 	reset_reference();
 	g_projection.set_stretch(true);
 
 	player_open_file(make_absolute(initial_file_name));
+	g_mesh_cache.warm(g_projection);
 
 	// main loop
 	while (g_Running)
 	{
+		std::pair<std::vector<Vertex>, std::vector<GLuint> > mesh;
+		std::string mesh_key;
+
+		if (g_projection_worker.fetch(mesh_key, mesh))
+		{
+			g_mesh_cache.insert(mesh_key, mesh.first, mesh.second);
+		}
+
 		// read user inputs
 		g_vr.update();
 		g_vr.read_poses();
 
+		const OpenVRInterface::frame_timing_t timing = g_vr.frame_timing();
+		g_player.vsync(timing.refresh_rate, timing.display_delay, timing.vsync);
+
 		const OpenVRInterface::input_state_t& input_state = g_vr.read_input();
 		float length = glm::length(input_state.pad.position);
 
@@ -450,6 +685,19 @@ int main(void)
 
 		setup_hmd(hmdPose);
 
+		if (g_projection.use_raycast() && (g_projection.projection() == Projection::PROJECTION_CUBE_MAP))
+		{
+			update_cube_maps();
+		}
+
+		/* the GPU time of the previous render path is logged for comparison */
+		if (g_projection.use_raycast() != g_canvas_raycast)
+		{
+			std::cout << "canvas GPU time (" << (g_canvas_raycast ? "raycast" : "mesh") << "): " << g_canvas_timer.time() << " ms per eye" << std::endl;
+			g_canvas_raycast = g_projection.use_raycast();
+			g_canvas_timer.reset();
+		}
+
 		// For each eye: render scene to texture
 		for (vr::Hmd_Eye eye : Eyes())
 		{
@@ -466,12 +714,12 @@ int main(void)
 			{
 				case SOURCE_IMAGE:
 					g_image.bind();
-					g_canvas.draw();
+					draw_canvas(eye);
 					g_image.unbind();
 					break;
 				case SOURCE_VIDEO:
 					g_player.bind();
-					g_canvas.draw();
+					draw_canvas(eye);
 					g_player.unbind();
 					break;
 				default:
@@ -521,6 +769,16 @@ int main(void)
 	}
 
 	// Cleanup
+	g_projection_worker.stop();
+	g_library.stop();
+	g_reader.stop();
+	g_mesh_cache.clear();
+	g_canvas_timer.remove();
+
+	for (std::vector<CubeMap>::iterator iter = g_cube_map.begin(); iter != g_cube_map.end(); ++iter)
+	{
+		iter->remove();
+	}
 	glfwTerminate();
 	return 0;
 }
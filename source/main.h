@@ -8,6 +8,7 @@
 #include "gui/projection.h"
 #include "opengl/shader_set.h"
 #include "player/player.h"
+#include "util/media_library.h"
 
 void quit(void);
 void player_backward(void);
@@ -21,8 +22,10 @@ void player_show_desktop(void);
 float player_volume(void);
 void player_set_volume(const float vol);
 Player& player(void);
+MediaLibrary& library(void);
 Projection& projection(void);
 void update_projection(void);
+float canvas_gpu_time(void);
 ShaderSet& shader(void);
 
 #endif
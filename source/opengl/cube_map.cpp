@@ -0,0 +1,130 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#define GL_GLEXT_PROTOTYPES
+
+#include "cube_map.h"
+#include <iostream>
+#include <stdexcept>
+
+static const size_t num_faces = 6;
+
+CubeMap::CubeMap(void) :
+	m_id(0),
+	m_framebuffer(0),
+	m_slot(0),
+	m_face_size(0)
+{
+}
+
+GLuint CubeMap::id(void) const
+{
+	return m_id;
+}
+
+GLuint CubeMap::face_size(void) const
+{
+	return m_face_size;
+}
+
+/** allocate the six faces of the cube map.
+ * The storage is only reallocated, if the size of the faces changes.
+ * @param face_size edge length of the square faces in pixels.
+ * @param slot texture unit to bind the cube map to.
+ */
+void CubeMap::init(const GLuint face_size, const GLuint slot)
+{
+	m_slot = slot;
+
+	if (m_id && (m_face_size == face_size))
+	{
+		return;
+	}
+
+	if (!m_id)
+	{
+		glGenTextures(1, &m_id);
+		glGenFramebuffers(1, &m_framebuffer);
+	}
+
+	if ((m_id == 0) || (m_framebuffer == 0))
+	{
+		throw std::runtime_error("cube map not initialized");
+	}
+
+	m_face_size = face_size;
+
+	glActiveTexture(GL_TEXTURE0 + m_slot);
+	glBindTexture(GL_TEXTURE_CUBE_MAP, m_id);
+
+	for (size_t face = 0; face < num_faces; face++)
+	{
+		glTexImage2D(static_cast<GLenum>(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face), 0, GL_RGBA8,
+		             static_cast<GLsizei>(m_face_size), static_cast<GLsizei>(m_face_size), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	}
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, 0);
+	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+}
+
+/** fill the faces of the cube map from the bound source texture.
+ * Every face is rendered with a full screen quad, the shader maps the
+ * face coordinates to a direction and samples the source layout for it.
+ * @param shader repacking shader, with the source texture configured.
+ * @param quad full screen quad.
+ */
+void CubeMap::repack(const ShaderSet& shader, const Shape& quad) const
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glViewport(0, 0, static_cast<GLsizei>(m_face_size), static_cast<GLsizei>(m_face_size));
+
+	for (size_t face = 0; face < num_faces; face++)
+	{
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, static_cast<GLenum>(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face), m_id, 0);
+
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		{
+			std::cerr << "cube map framebuffer incomplete" << std::endl;
+			break;
+		}
+
+		shader.set_uniform("face", static_cast<int>(face));
+		quad.draw();
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void CubeMap::bind(void) const
+{
+	glActiveTexture(GL_TEXTURE0 + m_slot);
+	glBindTexture(GL_TEXTURE_CUBE_MAP, m_id);
+	glActiveTexture(GL_TEXTURE0);
+}
+
+void CubeMap::unbind(void) const
+{
+	glActiveTexture(GL_TEXTURE0 + m_slot);
+	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+	glActiveTexture(GL_TEXTURE0);
+}
+
+void CubeMap::remove(void)
+{
+	if (m_framebuffer)
+	{
+		glDeleteFramebuffers(1, &m_framebuffer);
+		m_framebuffer = 0;
+	}
+
+	if (m_id)
+	{
+		glDeleteTextures(1, &m_id);
+		m_id = 0;
+	}
+	m_face_size = 0;
+}
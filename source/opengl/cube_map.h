@@ -0,0 +1,33 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef CUBE_MAP_H
+#define CUBE_MAP_H
+
+#include <GL/gl.h>
+#include "shader_set.h"
+#include "shape.h"
+
+class CubeMap
+{
+	private:
+		GLuint m_id;
+		GLuint m_framebuffer;
+		GLuint m_slot;
+		GLuint m_face_size;
+
+	public:
+		CubeMap(void);
+
+		GLuint id(void) const;
+		GLuint face_size(void) const;
+
+		void init(const GLuint face_size, const GLuint slot);
+		void repack(const ShaderSet& shader, const Shape& quad) const;
+		void bind(void) const;
+		void unbind(void) const;
+		void remove(void);
+};
+
+#endif
@@ -31,7 +31,10 @@ GLenum EBO::index_format(void) const
 
 void EBO::init(const std::vector<GLuint>& indices)
 {
-	glGenBuffers(1, &m_id);
+	if (!m_id)
+	{
+		glGenBuffers(1, &m_id);
+	}
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(GLuint) * indices.size()), indices.data(), GL_STATIC_DRAW);
 
@@ -39,9 +42,33 @@ void EBO::init(const std::vector<GLuint>& indices)
 	m_index_format = GL_UNSIGNED_INT;
 }
 
+/** replace the indices of an initialized buffer, like VBO::update_data(). */
+void EBO::update(const std::vector<GLuint>& indices)
+{
+	const GLsizeiptr size = static_cast<GLsizeiptr>(sizeof(GLuint) * indices.size());
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
+
+	if ((indices.size() == m_num_indices) && (m_index_format == GL_UNSIGNED_INT))
+	{
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, size, indices.data());
+	}
+	else
+	{
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, indices.data(), GL_DYNAMIC_DRAW);
+	}
+
+	m_num_indices = static_cast<GLuint>(indices.size());
+	m_index_format = GL_UNSIGNED_INT;
+}
+
 void EBO::init(const vr::RenderModel_t& model)
 {
-	glGenBuffers(1, &m_id);
+	if (!m_id)
+	{
+		glGenBuffers(1, &m_id);
+	}
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint16_t) * model.unTriangleCount * 3, model.rIndexData, GL_STATIC_DRAW);
 
@@ -25,6 +25,7 @@ class EBO
 
 		void init(const std::vector<GLuint>& vertices);
 		void init(const vr::RenderModel_t& model);
+		void update(const std::vector<GLuint>& indices);
 		void bind(void) const;
 		void unbind(void) const;
 		void remove();
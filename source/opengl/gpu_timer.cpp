@@ -0,0 +1,119 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#define GL_GLEXT_PROTOTYPES
+
+#include "gpu_timer.h"
+#include <GL/glext.h>
+
+static const float time_smoothing = 0.05f;
+
+/** measure the GPU time of draw calls with timer queries.
+ * Results are read back a few frames later, when they are available,
+ * so measuring never waits for the GPU.
+ */
+GpuTimer::GpuTimer(void) :
+	m_queries(),
+	m_next(0),
+	m_pending(0),
+	m_discard(0),
+	m_active(false),
+	m_time(0.0f)
+{
+}
+
+/** create the queries.
+ * @param count number of measurements in flight.
+ */
+void GpuTimer::init(const size_t count)
+{
+	m_queries.resize(count, 0);
+	glGenQueries(static_cast<GLsizei>(m_queries.size()), m_queries.data());
+	m_next = 0;
+	m_pending = 0;
+	m_discard = 0;
+}
+
+void GpuTimer::remove(void)
+{
+	if (!m_queries.empty())
+	{
+		glDeleteQueries(static_cast<GLsizei>(m_queries.size()), m_queries.data());
+		m_queries.clear();
+	}
+}
+
+/** restart averaging, e.g. after the measured draw calls changed.
+ * Measurements still in flight are discarded.
+ */
+void GpuTimer::reset(void)
+{
+	m_discard = m_pending;
+	m_time = 0.0f;
+}
+
+/** read back the measurements that have completed, oldest first. */
+void GpuTimer::collect(void)
+{
+	while (m_pending > 0)
+	{
+		const GLuint query = m_queries[(m_next + m_queries.size() - m_pending) % m_queries.size()];
+		GLint available = 0;
+
+		glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+
+		if (!available)
+		{
+			break;
+		}
+
+		GLuint64 elapsed = 0;
+
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+		m_pending--;
+
+		if (m_discard > 0)
+		{
+			m_discard--;
+			continue;
+		}
+
+		const float time = 1e-6f * static_cast<float>(elapsed);
+		m_time = (m_time > 0.0f) ? (m_time + time_smoothing * (time - m_time)) : time;
+	}
+}
+
+/** start measuring.
+ * While all queries are in flight, the draw calls are not measured.
+ */
+void GpuTimer::begin(void)
+{
+	collect();
+
+	m_active = !m_queries.empty() && (m_pending < m_queries.size());
+
+	if (m_active)
+	{
+		glBeginQuery(GL_TIME_ELAPSED, m_queries[m_next]);
+	}
+}
+
+void GpuTimer::end(void)
+{
+	if (m_active)
+	{
+		glEndQuery(GL_TIME_ELAPSED);
+		m_next = (m_next + 1) % m_queries.size();
+		m_pending++;
+		m_active = false;
+	}
+}
+
+/** smoothed GPU time of the measured draw calls.
+ * @return time in milliseconds, 0 before the first measurement completed.
+ */
+float GpuTimer::time(void) const
+{
+	return m_time;
+}
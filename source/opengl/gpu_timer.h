@@ -0,0 +1,35 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+#include <GL/gl.h>
+#include <stddef.h>
+#include <vector>
+
+class GpuTimer
+{
+	private:
+		std::vector<GLuint> m_queries;
+		size_t m_next;          /* query of the next measurement */
+		size_t m_pending;       /* measurements not yet read back */
+		size_t m_discard;       /* pending measurements started before a reset */
+		bool m_active;
+		float m_time;           /* milliseconds */
+
+		void collect(void);
+
+	public:
+		GpuTimer(void);
+
+		void init(const size_t count);
+		void remove(void);
+		void reset(void);
+		void begin(void);
+		void end(void);
+		float time(void) const;
+};
+
+#endif
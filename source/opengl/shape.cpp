@@ -109,6 +109,27 @@ void Shape::init_vertices(const std::vector<Vertex>& vertices, const std::vector
 	m_ebo.unbind();
 }
 
+/** replace the geometry of an initialized shape.
+ * The vertex array and buffers are kept, so the attributes need not be linked again.
+ */
+void Shape::update_vertices(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices)
+{
+	if (!m_vao.id())
+	{
+		init_vertices(vertices, indices, m_shape_type);
+		return;
+	}
+
+	m_vbo.update_data(vertices);
+	m_vbo.unbind();
+
+	/* the element buffer binding is part of the vertex array state */
+	m_vao.bind();
+	m_ebo.update(indices);
+	m_vao.unbind();
+	m_ebo.unbind();
+}
+
 void Shape::init_openvr_model(const std::string& name)
 {
 	vr::RenderModel_t* model;
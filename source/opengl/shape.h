@@ -33,6 +33,7 @@ class Shape
 		void set_transform(const glm::mat4& transform, const size_t instance = 0) const;
 
 		void init_vertices(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices, const GLenum type = GL_TRIANGLES);
+		void update_vertices(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices);
 		void init_openvr_model(const std::string& name);
 
 		void draw(void) const;
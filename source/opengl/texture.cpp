@@ -5,7 +5,6 @@
 #define GL_GLEXT_PROTOTYPES
 
 #include "texture.h"
-#include "util/image_data.h"
 #include <chrono>
 #include <thread>
 #include <sstream>
@@ -69,9 +68,12 @@ void Texture::init(const GLenum slot)
 
 glm::uvec2 Texture::init_image_file(const std::string& file_name, const GLuint slot)
 {
-	ImageFile m_image(file_name);
+	return init_image(ImageFile(file_name), slot);
+}
 
-	switch (m_image.bpp())
+glm::uvec2 Texture::init_image(const ImageFile& image, const GLuint slot)
+{
+	switch (image.bpp())
 	{
 		case 32:
 			m_format = GL_RGBA;
@@ -83,11 +85,24 @@ glm::uvec2 Texture::init_image_file(const std::string& file_name, const GLuint s
 			throw std::runtime_error("unsupported color depth");
 	}
 	init(slot);
-	glTexImage2D(tex_type, 0, internal_format, static_cast<GLsizei>(m_image.width()), static_cast<GLsizei>(m_image.height()), 0, m_format, GL_UNSIGNED_BYTE, m_image.pixels().data());
-	m_size = glm::uvec2(m_image.width(), m_image.height());
+	glTexImage2D(tex_type, 0, internal_format, static_cast<GLsizei>(image.width()), static_cast<GLsizei>(image.height()), 0, m_format, GL_UNSIGNED_BYTE, image.pixels().data());
+	m_size = glm::uvec2(image.width(), image.height());
 	return m_size;
 }
 
+/** load RGBA pixels into the texture.
+ * @param pixels rows of RGBA pixels, starting at the top.
+ * @param size width and height in pixels.
+ * @param slot texture unit.
+ */
+void Texture::init_pixels(const std::vector<uint8_t>& pixels, const glm::uvec2& size, const GLuint slot)
+{
+	m_format = GL_RGBA;
+	init(slot);
+	glTexImage2D(tex_type, 0, internal_format, static_cast<GLsizei>(size.x), static_cast<GLsizei>(size.y), 0, m_format, GL_UNSIGNED_BYTE, pixels.data());
+	m_size = size;
+}
+
 void Texture::init_dim(const glm::uvec2 size, const GLuint slot)
 {
 	if (m_size.x || m_size.y)
@@ -10,6 +10,7 @@
 #include <SDL3/SDL_surface.h>
 #include <string>
 #include <glm/glm.hpp>
+#include "util/image_data.h"
 
 class Texture
 {
@@ -29,6 +30,8 @@ class Texture
 		const glm::uvec2& size(void) const;
 
 		glm::uvec2 init_image_file(const std::string& file_name, const GLuint slot);
+		glm::uvec2 init_image(const ImageFile& image, const GLuint slot);
+		void init_pixels(const std::vector<uint8_t>& pixels, const glm::uvec2& size, const GLuint slot);
 		void init_sdl(const SDL_Surface* surface, const GLuint slot);
 		void init_dim(const glm::uvec2 size, const GLuint slot);
 		void init_openvr_model(const std::string& name, const GLuint slot);
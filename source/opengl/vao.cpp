@@ -18,7 +18,10 @@ GLuint VAO::id(void) const
 
 void VAO::init(void)
 {
-	glGenVertexArrays(1, &m_id);
+	if (!m_id)
+	{
+		glGenVertexArrays(1, &m_id);
+	}
 	glBindVertexArray(m_id);
 	// glCreateVertexArrays(1, &iVAO);
 }
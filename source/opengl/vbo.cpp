@@ -24,7 +24,10 @@ GLuint VBO::num_vertices(void) const
 
 void VBO::init(void)
 {
-	glGenBuffers(1, &m_id);
+	if (!m_id)
+	{
+		glGenBuffers(1, &m_id);
+	}
 }
 
 void VBO::load_data(const std::vector<Vertex>& vertices)
@@ -36,6 +39,30 @@ void VBO::load_data(const std::vector<Vertex>& vertices)
 	m_num_vertices = static_cast<GLuint>(vertices.size());
 }
 
+/** replace the vertices of an initialized buffer.
+ * A buffer of the same size is orphaned and refilled, so the driver does not
+ * wait for draw calls still using the previous content. Otherwise the storage
+ * is reallocated. In both cases the buffer name stays valid for linked arrays.
+ */
+void VBO::update_data(const std::vector<Vertex>& vertices)
+{
+	const GLsizeiptr size = static_cast<GLsizeiptr>(vertices.size() * sizeof(Vertex));
+
+	bind();
+
+	if (vertices.size() == m_num_vertices)
+	{
+		glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, size, vertices.data());
+	}
+	else
+	{
+		glBufferData(GL_ARRAY_BUFFER, size, vertices.data(), GL_DYNAMIC_DRAW);
+	}
+
+	m_num_vertices = static_cast<GLuint>(vertices.size());
+}
+
 void VBO::load_data(const vr::RenderModel_t& model)
 {
 	bind();
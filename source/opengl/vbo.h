@@ -24,6 +24,7 @@ class VBO
 
 		void init(void);
 		void load_data(const std::vector<Vertex>& vertices);
+		void update_data(const std::vector<Vertex>& vertices);
 		void load_data(const vr::RenderModel_t& model);
 		void load_data(const std::vector<glm::mat4>& transforms) const;
 		void bind(void) const;
@@ -0,0 +1,240 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "cache_config.h"
+#include "util/file_system.h"
+#include "util/string_tools.h"
+
+#include <stdlib.h>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <limits>
+
+/* The config file consists of profiles, each starting with its name in brackets:
+ *
+ *   [default]
+ *   demuxer-max-bytes = 512MiB
+ *   readahead = 64MiB
+ *
+ *   [large]
+ *   min-size = 4GiB
+ *   demuxer-max-bytes = 2GiB
+ *
+ * A profile applies to files of the listed "extensions" and of at least "min-size" bytes.
+ * The matching profiles are applied in the order of the file, so later profiles refine earlier ones.
+ * The first profile should match all files and set every option changed by the other profiles.
+ * "readahead" is the number of bytes the kernel is asked to read ahead of the play position,
+ * all other keys are passed to mpv as options.
+ */
+static const std::string key_extensions = "extensions";
+static const std::string key_min_size = "min-size";
+static const std::string key_readahead = "readahead";
+
+static const uint64_t mebibyte = 1024 * 1024;
+static const uint64_t gibibyte = 1024 * mebibyte;
+
+CacheConfig::CacheConfig(void) :
+	m_profiles()
+{
+	/* without a config file, the cache suits high bitrate video from local disks */
+	m_profiles.push_back(profile_t{"default", {}, 0, 0, {
+		{"cache", "yes"},
+		{"demuxer-max-bytes", "512MiB"},
+		{"demuxer-max-back-bytes", "128MiB"},
+		{"demuxer-readahead-secs", "20"},
+		{"stream-buffer-size", "4MiB"},
+		{key_readahead, "64MiB"}
+	}});
+	m_profiles.push_back(profile_t{"large", {}, 4 * gibibyte, 0, {
+		{"demuxer-max-bytes", "2GiB"},
+		{"demuxer-max-back-bytes", "256MiB"},
+		{"demuxer-readahead-secs", "60"},
+		{key_readahead, "256MiB"}
+	}});
+}
+
+/** location of the config file in the user's config directory. */
+std::string CacheConfig::default_config_file(void)
+{
+	const char* config = getenv("XDG_CONFIG_HOME");
+	const char* home = getenv("HOME");
+
+	if (config && config[0])
+	{
+		return std::string(config) + "/cine-vr/cache.conf";
+	}
+	return std::string(home ? home : "/tmp") + "/.config/cine-vr/cache.conf";
+}
+
+/** convert a size with an optional unit, e.g. "512MiB" or "4 GB".
+ * The unit is case insensitive, K, M and G are binary units like KiB, MiB and GiB,
+ * KB, MB and GB are decimal units.
+ * @param text size in bytes, or with a unit.
+ * @param size size in bytes.
+ * @return flag, whether the size is valid.
+ */
+bool CacheConfig::parse_size(const std::string& text, uint64_t& size)
+{
+	char* end = nullptr;
+	const double value = strtod(text.c_str(), &end);
+	std::string unit = trim(end ? std::string(end) : "");
+	double factor = 0.0;
+
+	for (std::string::iterator iter = unit.begin(); iter != unit.end(); ++iter)
+	{
+		*iter = static_cast<char>(tolower(*iter));
+	}
+
+	if (unit.empty() || (unit == "b"))
+	{
+		factor = 1.0;
+	}
+	else if ((unit == "k") || (unit == "kib"))
+	{
+		factor = 1024.0;
+	}
+	else if ((unit == "m") || (unit == "mib"))
+	{
+		factor = static_cast<double>(mebibyte);
+	}
+	else if ((unit == "g") || (unit == "gib"))
+	{
+		factor = static_cast<double>(gibibyte);
+	}
+	else if (unit == "kb")
+	{
+		factor = 1e3;
+	}
+	else if (unit == "mb")
+	{
+		factor = 1e6;
+	}
+	else if (unit == "gb")
+	{
+		factor = 1e9;
+	}
+
+	if ((end == text.c_str()) || (value < 0.0) || (factor <= 0.0))
+	{
+		return false;
+	}
+	size = static_cast<uint64_t>(value * factor);
+	return true;
+}
+
+/** read the profiles from a config file.
+ * Without a readable file, the built-in profiles are kept.
+ * @param file_name config file.
+ */
+void CacheConfig::load(const std::string& file_name)
+{
+	std::ifstream stream(file_name);
+
+	if (!stream.good())
+	{
+		return;
+	}
+
+	std::vector<profile_t> profiles;
+	std::string line;
+
+	for (size_t number = 1; std::getline(stream, line); number++)
+	{
+		line = trim(line);
+
+		if (line.empty() || (line[0] == '#') || (line[0] == ';'))
+		{
+			continue;
+		}
+
+		if ((line[0] == '[') && (line[line.size() - 1] == ']'))
+		{
+			profiles.push_back(profile_t{trim(line.substr(1, line.size() - 2)), {}, 0, 0, {}});
+			continue;
+		}
+
+		const size_t separator = line.find('=');
+
+		if ((separator == std::string::npos) || profiles.empty())
+		{
+			std::cerr << file_name << ":" << number << ": ignored line outside of a profile" << std::endl;
+			continue;
+		}
+
+		const std::string key = trim(line.substr(0, separator));
+		const std::string value = trim(line.substr(separator + 1));
+		profile_t& profile = profiles.back();
+		uint64_t size = 0;
+
+		if (key == key_extensions)
+		{
+			FileSystem fs;
+			std::istringstream list(value);
+			std::string ext;
+
+			while (list >> ext)
+			{
+				profile.extensions.insert(fs.extension("." + ext));
+			}
+		}
+		else if (key == key_min_size)
+		{
+			/* an invalid size disables the profile instead of applying it to all files */
+			if (!parse_size(value, profile.min_size))
+			{
+				std::cerr << file_name << ":" << number << ": invalid size " << value << ", profile " << profile.name << " disabled" << std::endl;
+				profile.min_size = std::numeric_limits<uint64_t>::max();
+			}
+		}
+		else if ((key == key_readahead) && !parse_size(value, size))
+		{
+			std::cerr << file_name << ":" << number << ": invalid size " << value << ", ignored" << std::endl;
+		}
+		else
+		{
+			profile.options[key] = value;
+		}
+	}
+
+	if (!profiles.empty())
+	{
+		m_profiles = profiles;
+	}
+	std::cout << "cache config " << file_name << ": " << profiles.size() << " profiles" << std::endl;
+}
+
+/** combine the profiles applying to a file.
+ * @param file_name media file.
+ * @param size file size in bytes.
+ * @return options of all matching profiles, named after them.
+ */
+CacheConfig::profile_t CacheConfig::select(const std::string& file_name, const uint64_t size) const
+{
+	FileSystem fs;
+	const std::string ext = fs.extension(file_name);
+	profile_t result = {"", {}, 0, 0, {}};
+
+	for (std::vector<profile_t>::const_iterator iter = m_profiles.begin(); iter != m_profiles.end(); ++iter)
+	{
+		if ((iter->extensions.empty() || iter->extensions.count(ext)) && (size >= iter->min_size))
+		{
+			result.name += (result.name.empty() ? "" : "+") + iter->name;
+
+			for (std::map<std::string, std::string>::const_iterator option = iter->options.begin(); option != iter->options.end(); ++option)
+			{
+				result.options[option->first] = option->second;
+			}
+		}
+	}
+
+	const std::map<std::string, std::string>::iterator readahead = result.options.find(key_readahead);
+
+	if (readahead != result.options.end())
+	{
+		parse_size(readahead->second, result.readahead);
+		result.options.erase(readahead);
+	}
+	return result;
+}
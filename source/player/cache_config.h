@@ -0,0 +1,40 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef CACHE_CONFIG_H
+#define CACHE_CONFIG_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+
+class CacheConfig
+{
+	public:
+		typedef struct
+		{
+			std::string name;
+			std::set<std::string> extensions;           /* file extensions the profile applies to, empty for all */
+			uint64_t min_size;                          /* minimum file size the profile applies to */
+			uint64_t readahead;                         /* bytes read ahead of the play position by the kernel */
+			std::map<std::string, std::string> options; /* mpv options */
+		}
+		profile_t;
+
+	private:
+		std::vector<profile_t> m_profiles;
+
+	public:
+		explicit CacheConfig(void);
+
+		static std::string default_config_file(void);
+		static bool parse_size(const std::string& text, uint64_t& size);
+
+		void load(const std::string& file_name);
+		profile_t select(const std::string& file_name, const uint64_t size) const;
+};
+
+#endif
@@ -0,0 +1,76 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "headless_mpv.h"
+
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/* maximum time to wait for a single event in seconds */
+static const double event_timeout = 0.1;
+
+/* scheduling priority of the background instances, the lowest one */
+static const int background_nice = 19;
+
+/** create an mpv instance for analysing a video in the background.
+ * The calling thread gets the lowest priority, which the threads of mpv inherit,
+ * so the playback in the foreground keeps the CPU.
+ * Audio and subtitles are disabled, the hardware decoder is left to the playback,
+ * seeks go to keyframes and the file stays open at its end.
+ * @param video_output video output of mpv, "null" without any rendering.
+ * @return initialised instance, nullptr on failure.
+ */
+mpv_handle* headless_mpv_create(const std::string& video_output)
+{
+	setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), background_nice);
+
+	mpv_handle* mpv = mpv_create();
+
+	if (!mpv)
+	{
+		return nullptr;
+	}
+
+	mpv_set_option_string(mpv, "vo", video_output.c_str());
+	mpv_set_option_string(mpv, "ao", "null");
+	mpv_set_option_string(mpv, "aid", "no");
+	mpv_set_option_string(mpv, "sid", "no");
+	mpv_set_option_string(mpv, "hwdec", "no");
+	mpv_set_option_string(mpv, "vd-lavc-skiploopfilter", "all");
+	mpv_set_option_string(mpv, "hr-seek", "no");
+	mpv_set_option_string(mpv, "keep-open", "always");
+	mpv_set_option_string(mpv, "pause", "yes");
+
+	if (mpv_initialize(mpv) < 0)
+	{
+		mpv_terminate_destroy(mpv);
+		return nullptr;
+	}
+	return mpv;
+}
+
+/** wait until loading a file or a seek completed.
+ * @param mpv instance created by headless_mpv_create().
+ * @param running flag to continue waiting.
+ * @return MPV_EVENT_PLAYBACK_RESTART after a completed seek,
+ *         MPV_EVENT_END_FILE at the end of the file, or MPV_EVENT_NONE when interrupted.
+ */
+mpv_event_id headless_mpv_wait(mpv_handle* mpv, const std::atomic<bool>& running)
+{
+	while (running.load())
+	{
+		const mpv_event* event = mpv_wait_event(mpv, event_timeout);
+
+		if ((event->event_id == MPV_EVENT_PLAYBACK_RESTART) || (event->event_id == MPV_EVENT_END_FILE))
+		{
+			return event->event_id;
+		}
+		else if (event->event_id == MPV_EVENT_SHUTDOWN)
+		{
+			break;
+		}
+	}
+	return MPV_EVENT_NONE;
+}
@@ -0,0 +1,15 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef HEADLESS_MPV_H
+#define HEADLESS_MPV_H
+
+#include <mpv/client.h>
+#include <string>
+#include <atomic>
+
+mpv_handle* headless_mpv_create(const std::string& video_output);
+mpv_event_id headless_mpv_wait(mpv_handle* mpv, const std::atomic<bool>& running);
+
+#endif
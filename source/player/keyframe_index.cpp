@@ -0,0 +1,353 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "keyframe_index.h"
+#include "headless_mpv.h"
+
+#include <sys/stat.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+
+/* The cache file consists of a header, the path of the video file
+ * and the keyframe timestamps as doubles in ascending order.
+ * Size and modification time of the video invalidate outdated entries.
+ */
+static const char cache_magic[8] = {'C', 'V', 'R', 'K', 'E', 'Y', 'F', 'R'};
+static const uint32_t cache_version = 1;
+
+/* forward step beyond the current keyframe, so a keyframe seek lands on the next one */
+static const char* const keyframe_step = "0.01";
+
+typedef struct
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t path_size;
+	uint64_t file_size;
+	int64_t mtime;
+	uint64_t count;
+}
+cache_header_t;
+
+KeyframeIndex::KeyframeIndex(void) :
+	m_times(),
+	m_generation(0),
+	m_request(""),
+	m_requested(false),
+	m_shutdown(false),
+	m_thread(),
+	m_running(false),
+	m_ready(false),
+	m_mutex(),
+	m_request_cv()
+{
+}
+
+KeyframeIndex::~KeyframeIndex(void)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_shutdown = true;
+		m_running.store(false);
+	}
+	m_request_cv.notify_all();
+
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+}
+
+/** location of the keyframe indices in the user's cache directory. */
+std::string KeyframeIndex::default_cache_dir(void)
+{
+	const char* cache = getenv("XDG_CACHE_HOME");
+	const char* home = getenv("HOME");
+
+	if (cache && cache[0])
+	{
+		return std::string(cache) + "/cine-vr/keyframes";
+	}
+	return std::string(home ? home : "/tmp") + "/.cache/cine-vr/keyframes";
+}
+
+/** provide the keyframes of a video file.
+ * The worker thread reads a cached index, or collects the keyframes otherwise.
+ * Only the worker is signalled, so the caller never waits for a previous file.
+ * @param file_name video file.
+ */
+void KeyframeIndex::start(const std::string& file_name)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_generation++;
+		m_request = file_name;
+		m_requested = true;
+		m_times.clear();
+		m_ready.store(false);
+		m_running.store(false);
+	}
+	m_request_cv.notify_one();
+
+	if (!m_thread.joinable())
+	{
+		m_thread = std::thread(&KeyframeIndex::worker_thread, this);
+	}
+}
+
+/** cancel the file in progress, without waiting for the worker thread.
+ */
+void KeyframeIndex::stop(void)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_generation++;
+	m_requested = false;
+	m_running.store(false);
+}
+
+/** handle the requested files one after another.
+ * Starting another file interrupts the current one.
+ */
+void KeyframeIndex::worker_thread(void)
+{
+	std::unique_lock<std::mutex> lk(m_mutex);
+
+	while (true)
+	{
+		m_request_cv.wait(lk, [this]{
+			return m_requested || m_shutdown;
+		});
+
+		if (m_shutdown)
+		{
+			break;
+		}
+
+		const std::string file_name = m_request;
+		const uint64_t generation = m_generation;
+
+		m_requested = false;
+		m_running.store(true);
+		lk.unlock();
+		collect(file_name, generation);
+		lk.lock();
+	}
+}
+
+/** provide the keyframes of a file from the cache, or by scanning the file.
+ * @param file_name video file.
+ * @param generation number of the request, results are dropped when another file was started meanwhile.
+ */
+void KeyframeIndex::collect(const std::string& file_name, const uint64_t generation)
+{
+	std::ostringstream cache_file;
+	cache_file << default_cache_dir() << "/" << std::hex << std::hash<std::string>()(file_name) << ".kfi";
+
+	std::vector<double> times;
+
+	if (load(file_name, cache_file.str(), times))
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (generation == m_generation)
+		{
+			m_times.swap(times);
+			m_ready.store(true);
+		}
+		return;
+	}
+
+	if (scan(file_name, generation, times))
+	{
+		save(file_name, cache_file.str(), times);
+	}
+}
+
+/** check whether all keyframes of the file are known.
+ * @return flag, whether the index is complete.
+ */
+bool KeyframeIndex::ready(void) const
+{
+	return m_ready.load();
+}
+
+/** find the keyframe closest to a time.
+ * While the index is collected, times beyond the last known keyframe are returned unchanged.
+ * @param time time in seconds.
+ * @return timestamp of the nearest keyframe in seconds.
+ */
+double KeyframeIndex::nearest(const double time) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_times.empty() || (!m_ready.load() && (time > m_times.back())))
+	{
+		return time;
+	}
+
+	const std::vector<double>::const_iterator next = std::lower_bound(m_times.begin(), m_times.end(), time);
+
+	if (next == m_times.begin())
+	{
+		return *next;
+	}
+	else if (next == m_times.end())
+	{
+		return m_times.back();
+	}
+
+	const double previous = *(next - 1);
+
+	return ((time - previous) < (*next - time)) ? previous : *next;
+}
+
+bool KeyframeIndex::load(const std::string& file_name, const std::string& cache_file, std::vector<double>& times)
+{
+	struct stat sb;
+	struct stat cache_sb;
+
+	if (stat(file_name.c_str(), &sb) || stat(cache_file.c_str(), &cache_sb))
+	{
+		return false;
+	}
+
+	std::ifstream stream(cache_file, std::ios::in | std::ios::binary);
+	cache_header_t header = {};
+
+	/* the count is checked against the size of the cache file before allocating, so a corrupt file is a cache miss */
+	if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+	    !std::equal(cache_magic, cache_magic + sizeof(cache_magic), header.magic) ||
+	    (header.version != cache_version) ||
+	    (header.file_size != static_cast<uint64_t>(sb.st_size)) ||
+	    (header.mtime != sb.st_mtim.tv_sec) ||
+	    (header.path_size != file_name.size()) ||
+	    (header.count > static_cast<uint64_t>(cache_sb.st_size) / sizeof(double)) ||
+	    (static_cast<uint64_t>(cache_sb.st_size) != sizeof(header) + header.path_size + header.count * sizeof(double)))
+	{
+		return false;
+	}
+
+	std::string path(header.path_size, '\0');
+
+	times.resize(header.count);
+
+	return stream.read(&path[0], static_cast<std::streamsize>(path.size())) && (path == file_name) &&
+	       stream.read(reinterpret_cast<char*>(times.data()), static_cast<std::streamsize>(times.size() * sizeof(double)));
+}
+
+void KeyframeIndex::save(const std::string& file_name, const std::string& cache_file, const std::vector<double>& times)
+{
+	struct stat sb;
+
+	if (stat(file_name.c_str(), &sb))
+	{
+		return;
+	}
+
+	/* create the cache directory including its parents */
+	for (size_t pos = cache_file.find('/', 1); pos != std::string::npos; pos = cache_file.find('/', pos + 1))
+	{
+		mkdir(cache_file.substr(0, pos).c_str(), 0755);
+	}
+
+	cache_header_t header = {};
+	std::copy(cache_magic, cache_magic + sizeof(cache_magic), header.magic);
+	header.version = cache_version;
+	header.path_size = static_cast<uint32_t>(file_name.size());
+	header.file_size = static_cast<uint64_t>(sb.st_size);
+	header.mtime = sb.st_mtim.tv_sec;
+	header.count = times.size();
+
+	/* the complete file replaces an existing one, so readers never see a partial index */
+	const std::string temp_file = cache_file + ".tmp";
+	bool success = false;
+
+	{
+		std::ofstream stream(temp_file, std::ios::out | std::ios::binary | std::ios::trunc);
+
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		stream.write(file_name.data(), static_cast<std::streamsize>(file_name.size()));
+		stream.write(reinterpret_cast<const char*>(times.data()), static_cast<std::streamsize>(times.size() * sizeof(double)));
+		success = stream.good();
+	}
+
+	if (!success || rename(temp_file.c_str(), cache_file.c_str()))
+	{
+		std::cerr << "could not write keyframe index " << cache_file << std::endl;
+		remove(temp_file.c_str());
+	}
+}
+
+/** collect the keyframes with a headless mpv instance.
+ * Starting from the first frame, every keyframe seek slightly forward lands on the next keyframe.
+ * Only keyframes are decoded, neither video nor audio is output.
+ * The keyframes found so far are usable while scanning.
+ * @param file_name video file.
+ * @param generation number of the request, see collect().
+ * @param times keyframe timestamps in seconds.
+ * @return flag, whether all keyframes of the file were found.
+ */
+bool KeyframeIndex::scan(const std::string& file_name, const uint64_t generation, std::vector<double>& times)
+{
+	mpv_handle* mpv = headless_mpv_create("null");
+
+	if (!mpv)
+	{
+		return false;
+	}
+
+	std::vector<const char*> load_cmd = {"loadfile", file_name.c_str(), nullptr};
+	std::vector<const char*> seek_cmd = {"seek", keyframe_step, "relative+keyframes", nullptr};
+	bool complete = false;
+
+	if (mpv_command(mpv, load_cmd.data()) >= 0)
+	{
+		mpv_event_id status = headless_mpv_wait(mpv, m_running);
+		double last = -1.0;
+
+		while (status == MPV_EVENT_PLAYBACK_RESTART)
+		{
+			double pos = 0.0;
+			int eof = 0;
+
+			mpv_get_property(mpv, "eof-reached", MPV_FORMAT_FLAG, &eof);
+
+			/* a seek not moving forward anymore has reached the last keyframe */
+			if (eof || (mpv_get_property(mpv, "time-pos", MPV_FORMAT_DOUBLE, &pos) < 0) || (pos <= last))
+			{
+				status = MPV_EVENT_END_FILE;
+				break;
+			}
+
+			times.push_back(pos);
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+
+				if (generation == m_generation)
+				{
+					m_times.push_back(pos);
+				}
+			}
+			last = pos;
+
+			mpv_command(mpv, seek_cmd.data());
+			status = headless_mpv_wait(mpv, m_running);
+		}
+		complete = (status == MPV_EVENT_END_FILE) && (last >= 0.0);
+	}
+	mpv_terminate_destroy(mpv);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (complete && (generation == m_generation))
+	{
+		m_ready.store(true);
+	}
+	return complete;
+}
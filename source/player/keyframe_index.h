@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef KEYFRAME_INDEX_H
+#define KEYFRAME_INDEX_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+class KeyframeIndex
+{
+	private:
+		std::vector<double> m_times;    /* keyframe timestamps in seconds, ascending */
+		uint64_t m_generation;          /* counts the started files, results of previous files are dropped */
+		std::string m_request;          /* file waiting for the worker thread */
+		bool m_requested;
+		bool m_shutdown;
+		std::thread m_thread;
+		std::atomic<bool> m_running;    /* the file of the worker thread is still wanted */
+		std::atomic<bool> m_ready;
+		mutable std::mutex m_mutex;
+		std::condition_variable m_request_cv;
+
+		KeyframeIndex(const KeyframeIndex&);
+		KeyframeIndex& operator=(const KeyframeIndex&);
+
+		static bool load(const std::string& file_name, const std::string& cache_file, std::vector<double>& times);
+		static void save(const std::string& file_name, const std::string& cache_file, const std::vector<double>& times);
+		void collect(const std::string& file_name, const uint64_t generation);
+		bool scan(const std::string& file_name, const uint64_t generation, std::vector<double>& times);
+		void worker_thread(void);
+
+	public:
+		explicit KeyframeIndex(void);
+		~KeyframeIndex(void);
+
+		static std::string default_cache_dir(void);
+
+		void start(const std::string& file_name);
+		void stop(void);
+		bool ready(void) const;
+		double nearest(const double time) const;
+};
+
+#endif
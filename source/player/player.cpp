@@ -9,8 +9,82 @@
 #include <iostream>
 #include <vector>
 #include <sstream>
+#include <iomanip>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
 #include <mpv/render_gl.h>
 #include <GLFW/glfw3.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/* mpv renders into a ring of targets: one is displayed, one is rendered and one is ready for display */
+static const size_t video_targets = 3;
+
+/* the playback state is handed over in the same way: one copied, one written and one ready */
+static const size_t state_buffers = 3;
+
+/* flag in the index of a ready buffer, marking content not yet taken by the main loop */
+static const unsigned int fresh_buffer = 0x100;
+
+/* video memory for the video targets in bytes, before released targets are freed */
+static const size_t video_memory_budget = 768 * 1024 * 1024;
+
+/* steps of the video target size relative to the video size, limiting the number of distinct target sizes */
+static const float target_scale_steps = 8.0f;
+
+/* times closer than this in seconds refer to the same keyframe */
+static const double keyframe_tolerance = 0.001;
+
+/* weight of the latest frame in the average render time */
+static const float render_smoothing = 0.05f;
+
+/* interval of the statistics in the log */
+static const std::chrono::seconds stats_interval(10);
+
+/* the kernel is asked for the next readahead window, when less than this fraction of it is left */
+static const uint64_t readahead_refill = 2;
+
+/* maximum time to wait for the GPU to complete a video frame in nanoseconds */
+static const GLuint64 frame_timeout = 1000000000;
+
+/** size of the video target.
+ * When the eye resolves fewer texels than decoded, mpv scales the video down with its own scaler.
+ * @param video size of the decoded video frames.
+ * @param crop fraction of the video width and height to render.
+ * @param width resolvable texture width, see Projection::texture_width(), or 0 for the full size.
+ * @return size of the video target in pixels.
+ */
+static glm::uvec2 target_size(const glm::uvec2& video, const glm::vec2& crop, const float width)
+{
+	const glm::uvec2 size(static_cast<GLuint>(crop.x * static_cast<float>(video.x)), static_cast<GLuint>(crop.y * static_cast<float>(video.y)));
+
+	if ((width <= 0.0f) || (size.x == 0) || (width >= static_cast<float>(size.x)))
+	{
+		return size;
+	}
+
+	const float scale = std::min(1.0f, ceilf(target_scale_steps * width / static_cast<float>(size.x)) / target_scale_steps);
+
+	return glm::uvec2(static_cast<GLuint>(std::max(1.0f, roundf(scale * static_cast<float>(size.x)))),
+	                  static_cast<GLuint>(std::max(1.0f, roundf(scale * static_cast<float>(size.y)))));
+}
+
+/** size of a local file.
+ * @param file_name file to check.
+ * @return size in bytes, 0 if the file is not found.
+ */
+static uint64_t file_size(const std::string& file_name)
+{
+	struct stat sb;
+
+	if (stat(file_name.c_str(), &sb) || !S_ISREG(sb.st_mode))
+	{
+		return 0;
+	}
+	return static_cast<uint64_t>(sb.st_size);
+}
 
 // Returns the address of the specified function (name) for the given context (ctx)
 static void* get_proc_address(void* ctx __attribute__((unused)), const char* name)
@@ -20,21 +94,61 @@ static void* get_proc_address(void* ctx __attribute__((unused)), const char* nam
 }
 
 Player::Player(void) :
-	m_framebuffer(0),
-	m_video_texture(0),
-	m_playtime(0.0),
-	m_duration(0.0),
-	m_title(""),
+	m_pool(video_memory_budget),
+	m_targets(video_targets, VideoTargetPool::target_t{0, 0, glm::uvec2(0, 0)}),
+	m_display(0),
+	m_write(1),
+	m_ready(2),
+	m_states(state_buffers, playback_state_t{}),
+	m_state_read(0),
+	m_state_write(1),
+	m_state_ready(2),
+	m_state(m_states[0]),
 	m_size(0, 0),
 	m_playing(false),
+	m_frames(0),
 	m_render_thread(),
 	m_thread_running(false),
 	m_wakeup(false),
 	m_wakeup_mutex(),
 	m_wakeup_cv(),
+	m_event_thread(),
+	m_events_running(false),
+	m_events_pending(false),
+	m_event_mutex(),
+	m_event_cv(),
+	m_crop_mutex(),
+	m_crop(1.0f, 1.0f),
+	m_texture_width(0.0f),
+	m_vsync(false),
+	m_refresh_rate(0.0f),
+	m_display_time(0),
+	m_vsync_count(0),
+	m_fps(0.0),
+	m_cadence_frames(0),
+	m_cadence_breaks(0),
+	m_cadence_reset(false),
 	m_window(nullptr),
+	m_render_window(nullptr),
 	m_context(mpv_create()),
-	m_render(nullptr)
+	m_render(nullptr),
+	m_preloaded(""),
+	m_open_start(),
+	m_open_frames(0),
+	m_open_kind(""),
+	m_keyframes(),
+	m_scrub_target(-1.0),
+	m_thumbnails(),
+	m_thumbnail_texture(),
+	m_render_time(0.0f),
+	m_stats_logged(),
+	m_cache_config(),
+	m_cache_limit(0),
+	m_readahead_mutex(),
+	m_readahead_file(""),
+	m_readahead_size(0),
+	m_readahead_window(0),
+	m_readahead_end(0)
 {
 	if (!m_context)
 	{
@@ -44,12 +158,32 @@ Player::Player(void) :
 
 Player::~Player(void)
 {
-	if (m_context)
+	destroy_context();
+}
+
+/** stop both threads and release the render context and the mpv core.
+ */
+void Player::destroy_context(void)
+{
+	stop_event_thread();
+	stop_render_thread();
+
+	if (m_render)
 	{
+		/* the render context must be released with its OpenGL context current */
+		glfwMakeContextCurrent(m_render_window);
 		mpv_render_context_set_update_callback(m_render, nullptr, nullptr);
+		mpv_render_context_free(m_render);
+		m_render = nullptr;
+		glfwMakeContextCurrent(m_window);
+	}
+
+	if (m_context)
+	{
 		mpv_terminate_destroy(m_context);
 	}
 	m_context = nullptr;
+	m_preloaded.clear();
 }
 
 void Player::thread_starter(Player* player)
@@ -57,18 +191,45 @@ void Player::thread_starter(Player* player)
 	player->render_thread();
 }
 
+void Player::event_starter(Player* player)
+{
+	player->event_thread();
+}
+
+/** render the video frames of mpv in the background.
+ * The thread owns the shared render context, so expensive frames never delay the VR loop.
+ * A completed frame is handed over only after its fence signalled,
+ * hence the main loop samples it without waiting for the GPU.
+ */
 void Player::render_thread(void)
 {
-	glfwMakeContextCurrent(glfwGetCurrentContext());
+	glfwMakeContextCurrent(m_render_window);
+
+	bool frame_pending = false;
+	uint64_t shown_vsync = 0;
+	glm::uvec2 rendered_size(0, 0);
 
 	while (m_thread_running.load())
 	{
+		glm::uvec2 size;
+		bool vsync = false;
+		int64_t display_time = 0;
+		uint64_t vsync_count = 0;
+		float refresh_rate = 0.0f;
+		double fps = 0.0;
 		{
 			std::unique_lock<std::mutex> lk(m_wakeup_mutex);
 			m_wakeup_cv.wait(lk, [this]{
-				return m_wakeup.load() || !m_thread_running.load();
+				return m_wakeup.load() || m_vsync || !m_thread_running.load();
 			});
 			m_wakeup.store(false);
+			vsync = m_vsync;
+			m_vsync = false;
+			size = target_size(m_size, m_crop, m_texture_width);
+			display_time = m_display_time;
+			vsync_count = m_vsync_count;
+			refresh_rate = m_refresh_rate;
+			fps = m_fps;
 		}
 
 		if (!m_thread_running.load())
@@ -76,24 +237,101 @@ void Player::render_thread(void)
 			break;
 		}
 
-		if (mpv_render_context_update(m_render) & MPV_RENDER_UPDATE_FRAME)
+		/* the cadence of a new file is counted from its first presented frame */
+		if (m_cadence_reset.exchange(false))
 		{
+			m_cadence_frames.store(0);
+			m_cadence_breaks.store(0);
+			shown_vsync = 0;
+		}
+
+		/* a new target size needs the current frame again, also while paused */
+		if ((mpv_render_context_update(m_render) & MPV_RENDER_UPDATE_FRAME) || (size != rendered_size))
+		{
+			frame_pending = true;
+		}
+
+		/* with the timing of the HMD, frames are presented on its vsync only */
+		const bool paced = (refresh_rate > 0.0f);
+		mpv_render_frame_info info = {0, 0};
+
+		if (paced)
+		{
+			mpv_render_context_get_info(m_render, {MPV_RENDER_PARAM_NEXT_FRAME_INFO, &info});
+		}
+
+		/* a frame is due, if its target time lies before the middle of the next display interval */
+		const bool due = !paced ||
+		                 !(info.flags & MPV_RENDER_FRAME_INFO_PRESENT) ||
+		                 (info.flags & MPV_RENDER_FRAME_INFO_REDRAW) ||
+		                 (info.target_time <= display_time + static_cast<int64_t>(0.5e6f / refresh_rate));
+
+		if (frame_pending && (vsync || !paced) && due && (size.x > 0) && (size.y > 0))
+		{
+			VideoTargetPool::target_t& target = m_targets[m_write];
+
+			/* targets of another size are swapped one by one, while they are owned by this thread */
+			if (target.size != size)
+			{
+				m_pool.release(target);
+				target = m_pool.acquire(size);
+			}
+
+			int block_for_target = paced ? 0 : 1;
 			mpv_opengl_fbo mpv_fbo{
-				static_cast<int>(m_framebuffer),
-				static_cast<int>(m_size.x),
-				static_cast<int>(m_size.y),
+				static_cast<int>(target.framebuffer),
+				static_cast<int>(size.x),
+				static_cast<int>(size.y),
 				0
 			};
 			mpv_render_param params_fbo[] = {
 				{MPV_RENDER_PARAM_OPENGL_FBO, &mpv_fbo},
+				{MPV_RENDER_PARAM_BLOCK_FOR_TARGET_TIME, &block_for_target},
 				{MPV_RENDER_PARAM_INVALID, nullptr}
 			};
 
-			glDisable(GL_CULL_FACE);
+			const std::chrono::steady_clock::time_point render_start = std::chrono::steady_clock::now();
+
 			mpv_render_context_render(m_render, params_fbo);
-			glEnable(GL_CULL_FACE);
+			frame_pending = false;
+			rendered_size = size;
+
+			GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, frame_timeout);
+			glDeleteSync(fence);
+
+			const std::chrono::duration<float, std::milli> render_time = std::chrono::steady_clock::now() - render_start;
+			m_render_time.store(m_render_time.load() + render_smoothing * (render_time.count() - m_render_time.load()));
+
+			m_write = m_ready.exchange(m_write | fresh_buffer) & ~fresh_buffer;
+
+			/* each video frame should be shown for the same number of vsyncs, within one vsync */
+			if (paced && (info.flags & MPV_RENDER_FRAME_INFO_PRESENT) && !(info.flags & MPV_RENDER_FRAME_INFO_REDRAW))
+			{
+				if ((shown_vsync > 0) && (fps > 0.0))
+				{
+					const double cadence = static_cast<double>(refresh_rate) / fps;
+					const double held = static_cast<double>(vsync_count - shown_vsync);
+
+					m_cadence_frames++;
+
+					if ((held < floor(cadence)) || (held > ceil(cadence)))
+					{
+						m_cadence_breaks++;
+					}
+				}
+				shown_vsync = vsync_count;
+			}
+		}
+
+		if (vsync)
+		{
+			mpv_render_context_report_swap(m_render);
 		}
 	}
+
+	/* the render context and the video targets are released by the main loop */
+	glfwMakeContextCurrent(nullptr);
 }
 
 void Player::start_render_thread(void)
@@ -114,7 +352,10 @@ void Player::stop_render_thread(void)
 		return;
 	}
 
-	m_thread_running.store(false);
+	{
+		std::lock_guard<std::mutex> lock(m_wakeup_mutex);
+		m_thread_running.store(false);
+	}
 	m_wakeup_cv.notify_all();
 
 	if (m_render_thread.joinable())
@@ -123,13 +364,93 @@ void Player::stop_render_thread(void)
 	}
 }
 
+/** handle the events of mpv in the background.
+ * mpv calls the wakeup callback from its own threads, which must not call back into mpv,
+ * so it only wakes this thread. The events are drained here, and the resulting state
+ * is published to the main loop without any lock.
+ */
+void Player::event_thread(void)
+{
+	playback_state_t state = {};
+
+	publish_state(state);
+
+	while (m_events_running.load())
+	{
+		{
+			std::unique_lock<std::mutex> lk(m_event_mutex);
+			m_event_cv.wait(lk, [this]{
+				return m_events_pending || !m_events_running.load();
+			});
+			m_events_pending = false;
+		}
+
+		if (!m_events_running.load())
+		{
+			break;
+		}
+
+		for (mpv_event* event = mpv_wait_event(m_context, 0); event->event_id != MPV_EVENT_NONE; event = mpv_wait_event(m_context, 0))
+		{
+			process_event(*event, state);
+		}
+		publish_state(state);
+	}
+}
+
+void Player::start_event_thread(void)
+{
+	if (m_events_running.load())
+	{
+		return;
+	}
+
+	m_events_pending = true;
+	m_events_running.store(true);
+	m_event_thread = std::thread(event_starter, this);
+}
+
+void Player::stop_event_thread(void)
+{
+	if (!m_events_running.load())
+	{
+		return;
+	}
+
+	mpv_set_wakeup_callback(m_context, nullptr, nullptr);
+
+	{
+		std::lock_guard<std::mutex> lock(m_event_mutex);
+		m_events_running.store(false);
+	}
+	m_event_cv.notify_all();
+
+	if (m_event_thread.joinable())
+	{
+		m_event_thread.join();
+	}
+}
+
+/** hand a complete playback state over to the main loop.
+ * @param state current state of the event thread.
+ */
+void Player::publish_state(const playback_state_t& state)
+{
+	m_states[m_state_write] = state;
+	m_state_write = m_state_ready.exchange(m_state_write | fresh_buffer) & ~fresh_buffer;
+}
+
 void Player::on_mpv_events(void* ctx)
 {
 	Player* self = static_cast<Player*>(ctx);
 
 	if (self)
 	{
-		self->handle_events();
+		{
+			std::lock_guard<std::mutex> lock(self->m_event_mutex);
+			self->m_events_pending = true;
+		}
+		self->m_event_cv.notify_one();
 	}
 }
 
@@ -139,178 +460,312 @@ void Player::on_render_update(void* ctx)
 
 	if (self)
 	{
-		self->m_wakeup.store(true);
+		{
+			std::lock_guard<std::mutex> lock(self->m_wakeup_mutex);
+			self->m_wakeup.store(true);
+		}
 		self->m_wakeup_cv.notify_one();
 	}
 }
 
-void Player::render_frame(void)
+/** take the latest completed video frame for display.
+ * The previously displayed target is handed back to the render thread.
+ */
+void Player::acquire_frame(void)
 {
-	// glfwMakeContextCurrent(glfwGetCurrentContext());
-	glfwMakeContextCurrent(m_window);
+	if (m_ready.load() & fresh_buffer)
+	{
+		m_display = m_ready.exchange(m_display) & ~fresh_buffer;
+		m_frames++;
+
+		if (!m_open_kind.empty() && (m_frames.load() > m_open_frames))
+		{
+			const std::chrono::duration<double, std::milli> latency = std::chrono::steady_clock::now() - m_open_start;
+
+			std::cout << "player open (" << m_open_kind << "): first frame after " << latency.count() << " ms" << std::endl;
+			m_open_kind.clear();
+		}
+	}
+}
 
-	if ((mpv_render_context_update(m_render) & MPV_RENDER_UPDATE_FRAME))
+/** report the timing of the upcoming HMD frame.
+ * The render thread then presents at most one video frame per vsync of the HMD,
+ * and mpv resamples the video to the refresh rate of the HMD.
+ * @param refresh_rate refresh rate of the HMD in Hz.
+ * @param display_delay seconds until the frame rendered now is displayed.
+ * @param vsync_count vsync counter of the HMD.
+ */
+void Player::vsync(const float refresh_rate, const float display_delay, const uint64_t vsync_count)
+{
+	if (!m_context)
 	{
-		mpv_opengl_fbo mpv_fbo = {
-			static_cast<int>(m_framebuffer),
-			static_cast<int>(m_size.x),
-			static_cast<int>(m_size.y),
-			0
-		};
+		return;
+	}
 
-		mpv_render_param params_fbo[] = {
-			{MPV_RENDER_PARAM_OPENGL_FBO, &mpv_fbo},
-			{MPV_RENDER_PARAM_INVALID, nullptr}
-		};
+	if (fabsf(refresh_rate - m_refresh_rate) > 0.01f)
+	{
+		std::ostringstream rate;
+		rate << refresh_rate;
+		mpv_set_property_string(m_context, "override-display-fps", rate.str().c_str());
+	}
 
-		glDisable(GL_CULL_FACE);          // culling needs to be be disabled or only a black rectangle is rendered
-		mpv_render_context_render(m_render, params_fbo);
-		glEnable(GL_CULL_FACE);
+	{
+		std::lock_guard<std::mutex> lock(m_wakeup_mutex);
+		m_refresh_rate = refresh_rate;
+		m_display_time = mpv_get_time_us(m_context) + static_cast<int64_t>(display_delay * 1.0e6f);
+		m_vsync_count = vsync_count;
+		m_vsync = true;
 	}
+	m_wakeup_cv.notify_one();
+}
 
-	m_wakeup.store(false);
+/** statistics of the playback, e.g. to find the cause of stuttering.
+ * @return statistics of the current file.
+ */
+Player::stats_t Player::stats(void) const
+{
+	stats_t s = m_state.stats;
+
+	s.render_time = m_render_time.load();
+	s.cache_limit = m_cache_limit.load();
+	s.cache_fill = (s.cache_limit > 0) ? static_cast<float>(static_cast<double>(s.cache_bytes) / static_cast<double>(s.cache_limit)) : 0.0f;
+	s.judder = judder();
+
+	return s;
 }
 
+/** share of video frames breaking the regular cadence.
+ * A frame breaks the cadence, when it is shown for more or fewer vsyncs
+ * than the ratio of the display refresh rate and the video frame rate, rounded up or down.
+ * @return judder as fraction of the presented video frames of the current file.
+ */
+float Player::judder(void) const
+{
+	const size_t frames = m_cadence_frames.load();
+
+	if (frames == 0)
+	{
+		return 0.0f;
+	}
+	return static_cast<float>(m_cadence_breaks.load()) / static_cast<float>(frames);
+}
+
+/** update the player on the main loop.
+ * Takes the latest video frame, the latest playback state and completed thumbnails,
+ * without calling into mpv.
+ */
 void Player::handle_events(void)
 {
-	if (!m_context)
+	acquire_frame();
+
+	std::vector<uint8_t> pixels;
+	glm::uvec2 atlas_size;
+
+	if (m_thumbnails.take(pixels, atlas_size))
+	{
+		m_thumbnail_texture.init_pixels(pixels, atlas_size, 0);
+		m_thumbnail_texture.unbind();
+	}
+
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+	if (m_render && (now - m_stats_logged >= stats_interval))
+	{
+		const stats_t s = stats();
+
+		std::cout << "player stats: " << s.fps << " fps, dropped " << s.frame_drops << " / decoder " << s.decoder_drops
+		          << ", delayed " << s.delayed_frames << ", avsync " << (1000.0 * s.avsync) << " ms, cache " << s.cache_duration
+		          << " s / " << (100.0f * s.cache_fill) << "%, hwdec " << s.hwdec << ", render " << s.render_time << " ms, judder " << (100.0f * s.judder) << "%" << std::endl;
+		m_stats_logged = now;
+	}
+
+	if (!(m_state_ready.load() & fresh_buffer))
 	{
 		return;
 	}
 
-	/* handle all sorts of MPV events.
-	 * A list of all properties is available at https://mpv.io/manual/master/#properties
-	 * A list of all event types is available at https://mpv.io/manual/master/#list-of-events
-	 * A list of all imput commands is available at https://mpv.io/manual/master/#list-of-input-commands
-	 */
-	bool more_events = true;
+	const glm::uvec2 size = m_state.size;
+
+	m_state_read = m_state_ready.exchange(m_state_read) & ~fresh_buffer;
+	const bool eof = m_state.eof;
+	const bool ended = m_state.ended;
+
+	m_state = m_states[m_state_read];
 
-	while (more_events)
+	/* mpv keeps the last frame at the end of the file, paused */
+	if ((m_state.eof && !eof) || (m_state.ended && !ended))
 	{
-		mpv_event* event = mpv_wait_event(m_context, 0);
+		m_playing = false;
+	}
 
-		switch (event->event_id)
+	/* the projection belongs to the main loop */
+	if ((m_state.size != size) && m_state.size.x && m_state.size.y)
+	{
+		projection().set_aspect(static_cast<float>(m_state.size.x) / static_cast<float>(m_state.size.y));
+		update_projection();
+	}
+}
+
+/** apply a single event of mpv to the playback state.
+ * Called on the event thread only. Property changes carry their new value.
+ * A list of all properties is available at https://mpv.io/manual/master/#properties
+ * A list of all event types is available at https://mpv.io/manual/master/#list-of-events
+ * A list of all imput commands is available at https://mpv.io/manual/master/#list-of-input-commands
+ * @param event event taken from mpv.
+ * @param state playback state to update.
+ */
+void Player::process_event(const mpv_event& event, playback_state_t& state)
+{
+	switch (event.event_id)
+	{
+		case MPV_EVENT_START_FILE:
+			state.eof = false;
+			state.ended = false;
+			break;
+		case MPV_EVENT_FILE_LOADED:
+			break;
+		case MPV_EVENT_END_FILE:
 		{
-			case MPV_EVENT_START_FILE:
-				break;
-			case MPV_EVENT_FILE_LOADED:
-				break;
-			case MPV_EVENT_END_FILE:
-			{
-				mpv_event_end_file* msg = static_cast<mpv_event_end_file*>(event->data);
+			const mpv_event_end_file* msg = static_cast<const mpv_event_end_file*>(event.data);
 
-				if (msg->reason == MPV_END_FILE_REASON_ERROR)
-				{
-					std::cout << "player thread stopped with error" << std::endl;
-				}
-				else if (msg->reason == MPV_END_FILE_REASON_EOF)
-				{
-					std::cout << "player reached end of file" << std::endl;
-				}
-				mpv_render_context_set_update_callback(m_render, nullptr, nullptr);
-				mpv_terminate_destroy(m_context);
-				m_context = nullptr;
-				return;
+			std::cout << "player judder: " << (100.0f * judder()) << "% of " << m_cadence_frames.load() << " frames off cadence" << std::endl;
+			m_cadence_reset.store(true);
+
+			if (msg->reason == MPV_END_FILE_REASON_ERROR)
+			{
+				std::cout << "player thread stopped with error" << std::endl;
+				state.ended = true;
 			}
-			case MPV_EVENT_AUDIO_RECONFIG:
-				break;
-			case MPV_EVENT_VIDEO_RECONFIG:
+			else if (msg->reason == MPV_END_FILE_REASON_EOF)
 			{
-				int64_t width = 0;
-				mpv_get_property(m_context, "width", MPV_FORMAT_INT64, &width);
+				std::cout << "player reached end of file" << std::endl;
+			}
+		}
+		break;
+		case MPV_EVENT_AUDIO_RECONFIG:
+			break;
+		case MPV_EVENT_VIDEO_RECONFIG:
+		{
+			int64_t width = 0;
+			mpv_get_property(m_context, "width", MPV_FORMAT_INT64, &width);
 
-				int64_t height = 0;
-				mpv_get_property(m_context, "height", MPV_FORMAT_INT64, &height);
+			int64_t height = 0;
+			mpv_get_property(m_context, "height", MPV_FORMAT_INT64, &height);
 
-				m_size.x = static_cast<GLuint>(width);
-				m_size.y = static_cast<GLuint>(height);
-				std::cout << "player video reconfiguration: " << m_size.x << " x " << m_size.y << std::endl;
+			state.size = glm::uvec2(static_cast<GLuint>(width), static_cast<GLuint>(height));
 
-				if (width && height)
-				{
-					// glfwMakeContextCurrent(glfwGetCurrentContext());
-					glfwMakeContextCurrent(m_window);
-
-					// Framebuffer for Video Target - Video Texture
-					glGenFramebuffers(1, &m_framebuffer);
-					glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
-					// create a color attachment texture
-					glGenTextures(1, &m_video_texture);
-					glBindTexture(GL_TEXTURE_2D, m_video_texture);
-					glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, static_cast<GLsizei>(m_size.x), static_cast<GLsizei>(m_size.y), 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
-					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-					glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_video_texture, 0);
-
-					if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-					{
-						std::cout << "failed creating framebuffer" << std::endl;
-					}
-					projection().set_aspect(static_cast<float>(width) / static_cast<float>(height));
-				}
-				glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			{
+				/* the render thread takes targets of the new size on the next frames */
+				std::lock_guard<std::mutex> lock(m_wakeup_mutex);
+				m_size = state.size;
 			}
+			std::cout << "player video reconfiguration: " << state.size.x << " x " << state.size.y << std::endl;
+			apply_crop();
+		}
+		break;
+		case MPV_EVENT_SEEK:
+			break;
+		case MPV_EVENT_PLAYBACK_RESTART:
 			break;
-			case MPV_EVENT_PLAYBACK_RESTART:
-				break;
-			case MPV_EVENT_PROPERTY_CHANGE:
+		case MPV_EVENT_PROPERTY_CHANGE:
+		{
+			const mpv_event_property* prop = static_cast<const mpv_event_property*>(event.data);
+			const std::string name = prop->name;
+
+			if (prop->format == MPV_FORMAT_DOUBLE)
 			{
-				mpv_event_property* prop = reinterpret_cast<mpv_event_property*>(event->data);
-				const std::string name = prop->name;
+				const double value = *static_cast<const double*>(prop->data);
 
 				if (name == "time-pos")
 				{
-					if (mpv_get_property(m_context, prop->name, MPV_FORMAT_DOUBLE, &m_playtime) < 0)
-					{
-						// throw std::runtime_error("failed fetching playtime property");
-					}
+					state.playtime = value;
+					advance_readahead(state.playtime, state.duration);
 				}
 				else if (name == "duration")
 				{
-					if (mpv_get_property(m_context, prop->name, MPV_FORMAT_DOUBLE, &m_duration) < 0)
-					{
-						// throw std::runtime_error("failed fetching duration property");
-					}
-					std::cout << "media duration: " << m_duration << std::endl;
+					state.duration = value;
+					std::cout << "media duration: " << value << std::endl;
 				}
-				else if (name == "media-title")
+				else if (name == "ao-volume")
 				{
-					const char* data = nullptr;
+					state.volume = value;
+				}
+				else if (name == "avsync")
+				{
+					state.stats.avsync = value;
+				}
+				else if (name == "estimated-vf-fps")
+				{
+					state.stats.fps = value;
+
+					std::lock_guard<std::mutex> lock(m_wakeup_mutex);
+					m_fps = value;
+				}
+			}
+			else if (prop->format == MPV_FORMAT_INT64)
+			{
+				const int64_t value = *static_cast<const int64_t*>(prop->data);
 
-					if (mpv_get_property(m_context, prop->name, MPV_FORMAT_STRING, &data) < 0)
+				if (name == "frame-drop-count")
+				{
+					state.stats.frame_drops = value;
+				}
+				else if (name == "decoder-frame-drop-count")
+				{
+					state.stats.decoder_drops = value;
+				}
+				else if (name == "vo-delayed-frame-count")
+				{
+					state.stats.delayed_frames = value;
+				}
+			}
+			else if ((prop->format == MPV_FORMAT_NODE) && (name == "demuxer-cache-state"))
+			{
+				const mpv_node* node = static_cast<const mpv_node*>(prop->data);
+
+				if (node->format == MPV_FORMAT_NODE_MAP)
+				{
+					for (int i = 0; i < node->u.list->num; i++)
 					{
+						const mpv_node& value = node->u.list->values[i];
+
+						const std::string key = node->u.list->keys[i];
+
+						if ((key == "cache-duration") && (value.format == MPV_FORMAT_DOUBLE))
+						{
+							state.stats.cache_duration = value.u.double_;
+						}
+						else if ((key == "fw-bytes") && (value.format == MPV_FORMAT_INT64))
+						{
+							state.stats.cache_bytes = value.u.int64;
+						}
 					}
-					m_title = data;
 				}
-				else
+			}
+			else if ((prop->format == MPV_FORMAT_FLAG) && (name == "eof-reached"))
+			{
+				state.eof = (*static_cast<const int*>(prop->data) != 0);
+			}
+			else if (prop->format == MPV_FORMAT_STRING)
+			{
+				const char* value = *static_cast<const char* const*>(prop->data);
+
+				if (name == "media-title")
+				{
+					state.title = value;
+				}
+				else if (name == "hwdec-current")
 				{
-					std::cout << "property change: " << prop->name << std::endl;
-					std::cout << "property format: " << prop->format << std::endl;
+					state.stats.hwdec = value;
 				}
 			}
-			break;
-// case MPV_EVENT_SHUTDOWN:
-// m_quit = true;
-// break;
-// case MPV_EVENT_LOG_MESSAGE:
-// {
-// mpv_event_log_message* msg = static_cast<mpv_event_log_message*>(event->data);
-// printf("[%s] %s: %s", msg->prefix, msg->level, msg->text);
-// }
-// break;
-			case MPV_EVENT_IDLE:
-			case MPV_EVENT_NONE:
-				more_events = false;
-				break;
-			default:
-				std::cout << "unhandled MPV event: " << event->event_id << std::endl;
-				break;
 		}
-	}
-
-	if (m_wakeup.load())
-	{
-		render_frame();
+		break;
+		case MPV_EVENT_IDLE:
+			break;
+		default:
+			std::cout << "unhandled MPV event: " << event.event_id << std::endl;
+			break;
 	}
 }
 
@@ -328,10 +783,12 @@ void Player::set_option(const std::string& key, const std::string& value) const
 	}
 }
 
-void Player::open_file(const std::string& file_name, GLFWwindow* window)
+/** set up the mpv core, its render context and the threads handling them.
+ * This is done once for all files, opening a file only replaces the loaded file.
+ * @param window window with the OpenGL context of the main loop.
+ */
+void Player::init(GLFWwindow* window)
 {
-	m_window = window;
-
 	if (!m_context)
 	{
 		m_context = mpv_create();
@@ -364,7 +821,25 @@ void Player::open_file(const std::string& file_name, GLFWwindow* window)
 		{ MPV_RENDER_PARAM_INVALID, nullptr }
 	};
 
-	if (mpv_render_context_create(&m_render, m_context, params) < 0)
+	if (!m_render_window)
+	{
+		/* invisible window providing the OpenGL context of the render thread, sharing textures with the main context */
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		m_render_window = glfwCreateWindow(1, 1, "Cine-VR video", NULL, window);
+		glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+
+		if (!m_render_window)
+		{
+			throw std::runtime_error("failed creating video render context");
+		}
+	}
+
+	/* the render context belongs to the OpenGL context of the render thread */
+	glfwMakeContextCurrent(m_render_window);
+	const int status = mpv_render_context_create(&m_render, m_context, params);
+	glfwMakeContextCurrent(window);
+
+	if (status < 0)
 	{
 		mpv_render_context_set_update_callback(m_render, nullptr, nullptr);
 		mpv_destroy(m_context);
@@ -373,7 +848,7 @@ void Player::open_file(const std::string& file_name, GLFWwindow* window)
 		throw std::runtime_error("Error: mpv_render_context_create failed");
 	}
 
-	// mpv_set_wakeup_callback(m_context, on_mpv_events, this);
+	mpv_set_wakeup_callback(m_context, on_mpv_events, this);
 	mpv_render_context_set_update_callback(m_render, on_render_update, this);
 
 	set_option("vd-lavc-dr", "yes");
@@ -382,28 +857,145 @@ void Player::open_file(const std::string& file_name, GLFWwindow* window)
 	set_option("profile", "gpu-hq");
 	set_option("gpu-api", "opengl");
 	set_option("vd-lavc-threads", "0");
+	set_option("video-sync", "display-resample");
+	set_option("keepaspect", "no");
+	set_option("keep-open", "always");
+	set_option("prefetch-playlist", "yes");
 	// set_option("force-window", "immediate");
-	// set_option("cache", "yes");
-	// set_option("cache-pause", "no");
+
+	/* the cache options are applied per file, see apply_cache_profile() */
+	m_cache_config.load(CacheConfig::default_config_file());
 
 	mpv_observe_property(m_context, 0, "duration", MPV_FORMAT_DOUBLE);
 	mpv_observe_property(m_context, 0, "time-pos", MPV_FORMAT_DOUBLE);
 	mpv_observe_property(m_context, 0, "estimated-vf-fps", MPV_FORMAT_DOUBLE);
-	mpv_observe_property(m_context, 0, "media-title", MPV_FORMAT_NONE);
+	mpv_observe_property(m_context, 0, "media-title", MPV_FORMAT_STRING);
+	mpv_observe_property(m_context, 0, "ao-volume", MPV_FORMAT_DOUBLE);
+	mpv_observe_property(m_context, 0, "eof-reached", MPV_FORMAT_FLAG);
+	mpv_observe_property(m_context, 0, "frame-drop-count", MPV_FORMAT_INT64);
+	mpv_observe_property(m_context, 0, "decoder-frame-drop-count", MPV_FORMAT_INT64);
+	mpv_observe_property(m_context, 0, "vo-delayed-frame-count", MPV_FORMAT_INT64);
+	mpv_observe_property(m_context, 0, "avsync", MPV_FORMAT_DOUBLE);
+	mpv_observe_property(m_context, 0, "demuxer-cache-state", MPV_FORMAT_NODE);
+	mpv_observe_property(m_context, 0, "hwdec-current", MPV_FORMAT_STRING);
+
+	m_cadence_frames.store(0);
+	m_cadence_breaks.store(0);
+	start_event_thread();
+	start_render_thread();
+}
 
-	std::vector<const char*> cmd = {"loadfile", file_name.c_str(), nullptr};
+/** open a file for playback.
+ * The first file sets up the player, later files replace the loaded file in the running core.
+ * The time until the first frame of the file is rendered is logged.
+ * @param file_name file to play.
+ * @param window window with the OpenGL context of the main loop.
+ */
+void Player::open_file(const std::string& file_name, GLFWwindow* window)
+{
+	const bool cold = !m_render;
+
+	m_window = window;
+	m_open_start = std::chrono::steady_clock::now();
+	m_open_frames = m_frames.load();
+	m_scrub_target = -1.0;
+	m_keyframes.start(file_name);
+	m_thumbnails.start(file_name);
+
+	if (cold)
+	{
+		init(window);
+	}
+	apply_cache_profile(file_name);
+
+	if (!cold && !m_preloaded.empty() && (file_name == m_preloaded))
+	{
+		/* the preloaded file continues in the running core, with its demuxer already filled */
+		std::vector<const char*> cmd = {"playlist-next", "force", nullptr};
+
+		m_preloaded.clear();
+
+		if (mpv_command(m_context, cmd.data()) >= 0)
+		{
+			m_open_kind = "preloaded";
+			play();
+			return;
+		}
+	}
+	m_open_kind = cold ? "cold" : "warm";
+
+	std::vector<const char*> cmd = {"loadfile", file_name.c_str(), "replace", nullptr};
+	std::vector<const char*> clear = {"playlist-clear", nullptr};
 
 	if (mpv_command(m_context, cmd.data()) < 0)
 	{
 		throw std::runtime_error("failed loading file: " + file_name);
 	}
 
+	/* a previously preloaded file is not needed anymore */
+	mpv_command(m_context, clear.data());
+	m_preloaded.clear();
+
 	play();
 }
 
+/** load a file in advance, which is likely opened next.
+ * mpv opens and buffers the next entry of its playlist while the current file plays,
+ * so open_file() with this file switches without setting up playback again.
+ * @param file_name file to preload.
+ */
+void Player::preload(const std::string& file_name)
+{
+	if (!m_context || (file_name == m_preloaded))
+	{
+		return;
+	}
+
+	/* the playlist holds the current file and the preloaded one only */
+	std::vector<const char*> clear = {"playlist-clear", nullptr};
+	std::vector<const char*> append = {"loadfile", file_name.c_str(), "append", nullptr};
+
+	mpv_command(m_context, clear.data());
+	m_preloaded.clear();
+
+	if (mpv_command(m_context, append.data()) >= 0)
+	{
+		m_preloaded = file_name;
+
+		/* the start of the preloaded file is read from disk, while the current file plays */
+		advise_readahead(file_name, 0, m_cache_config.select(file_name, file_size(file_name)).readahead);
+	}
+}
+
 void Player::close(void)
 {
 	pause();
+	m_keyframes.stop();
+	m_thumbnails.stop();
+	m_thumbnail_texture.remove();
+	destroy_context();
+
+	{
+		std::lock_guard<std::mutex> lock(m_readahead_mutex);
+		m_readahead_file.clear();
+	}
+	m_cache_limit.store(0);
+
+	if (m_render_window)
+	{
+		/* framebuffers can only be deleted in the context they were created in */
+		glfwMakeContextCurrent(m_render_window);
+
+		for (std::vector<VideoTargetPool::target_t>::iterator iter = m_targets.begin(); iter != m_targets.end(); ++iter)
+		{
+			m_pool.release(*iter);
+			*iter = VideoTargetPool::target_t{0, 0, glm::uvec2(0, 0)};
+		}
+		m_pool.clear();
+		glfwMakeContextCurrent(m_window);
+
+		std::cout << "video targets: " << m_pool.allocations() << " allocated, " << m_pool.reuses() << " reused" << std::endl;
+	}
 
 	std::cout << "player close" << std::endl;
 }
@@ -461,6 +1053,60 @@ void Player::jump(const float step)
 	}
 }
 
+/** move quickly to a position while it is dragged.
+ * Only keyframes are decoded, so the picture follows at interactive rates.
+ * Positions mapping to the keyframe shown already are skipped.
+ * @param position target time in seconds.
+ */
+void Player::scrub(const float position)
+{
+	if (!m_context)
+	{
+		return;
+	}
+
+	const double target = m_keyframes.nearest(static_cast<double>(position));
+
+	if (fabs(target - m_scrub_target) < keyframe_tolerance)
+	{
+		return;
+	}
+	m_scrub_target = target;
+
+	/* a slightly later time keeps rounding from landing on the previous keyframe */
+	std::ostringstream s;
+	s << std::fixed << std::setprecision(3) << (target + keyframe_tolerance);
+	const std::string t = s.str();
+
+	std::vector<const char*> cmd = { "seek", t.c_str(), "absolute+keyframes", nullptr };
+
+	mpv_command(m_context, cmd.data());
+}
+
+/** move exactly to a position, e.g. when dragging ended.
+ * @param position target time in seconds.
+ */
+void Player::seek(const float position)
+{
+	if (!m_context)
+	{
+		return;
+	}
+
+	std::ostringstream s;
+	s << std::fixed << std::setprecision(3) << position;
+	const std::string t = s.str();
+
+	std::vector<const char*> cmd = { "seek", t.c_str(), "absolute+exact", nullptr };
+
+	m_scrub_target = -1.0;
+
+	if (mpv_command(m_context, cmd.data()) < 0)
+	{
+		throw std::runtime_error("failed seeking.");
+	}
+}
+
 bool Player::is_playing(void) const
 {
 	return m_playing;
@@ -468,18 +1114,238 @@ bool Player::is_playing(void) const
 
 float Player::duration(void) const
 {
-	return static_cast<float>(m_duration);
+	return static_cast<float>(m_state.duration);
 }
 
 float Player::playtime(void) const
 {
-	return static_cast<float>(m_playtime);
+	return static_cast<float>(m_state.playtime);
+}
+
+/** size of the decoded video frames.
+ * @return width and height in pixels.
+ */
+const glm::uvec2& Player::size(void) const
+{
+	return m_state.size;
+}
+
+/** size of the video texture sampled for display.
+ * While a resize is in flight, this is the size of the displayed frame, not of the next one.
+ * @return width and height in pixels.
+ */
+glm::uvec2 Player::render_size(void) const
+{
+	return m_targets[m_display].size;
+}
+
+/** set the part of the video to render.
+ * The crop is applied by mpv before scaling, so the unused part costs no rendering.
+ * @param crop fraction of the video width and height to keep, starting at the top left corner.
+ */
+void Player::set_crop(const glm::vec2& crop)
+{
+	if (crop == m_crop)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_wakeup_mutex);
+		m_crop = crop;
+		m_wakeup.store(true);
+	}
+	m_wakeup_cv.notify_one();
+	apply_crop();
+}
+
+/** pass the crop to mpv in pixels of the decoded video.
+ * Called from the main loop and the event thread, the crop lock keeps the latest crop and size in mpv.
+ * The wakeup mutex is not held while calling mpv, as mpv takes it in the render update callback.
+ */
+void Player::apply_crop(void)
+{
+	std::lock_guard<std::mutex> crop_lock(m_crop_mutex);
+	glm::uvec2 size;
+	glm::vec2 fraction;
+
+	{
+		std::lock_guard<std::mutex> lock(m_wakeup_mutex);
+		size = m_size;
+		fraction = m_crop;
+	}
+
+	if (!m_context || (size.x == 0) || (size.y == 0))
+	{
+		return;
+	}
+
+	std::ostringstream crop;
+	crop << static_cast<GLuint>(fraction.x * static_cast<float>(size.x)) << "x"
+	     << static_cast<GLuint>(fraction.y * static_cast<float>(size.y)) << "+0+0";
+	mpv_set_property_string(m_context, "video-crop", crop.str().c_str());
+}
+
+/** apply the cache options of the profiles matching a file.
+ * The options of mpv are changed at runtime, so they also apply to the file already playing.
+ * The kernel is asked to read the start of the file ahead.
+ * @param file_name file to play.
+ */
+void Player::apply_cache_profile(const std::string& file_name)
+{
+	const uint64_t size = file_size(file_name);
+	const CacheConfig::profile_t profile = m_cache_config.select(file_name, size);
+
+	for (std::map<std::string, std::string>::const_iterator iter = profile.options.begin(); iter != profile.options.end(); ++iter)
+	{
+		const int status = mpv_set_property_string(m_context, iter->first.c_str(), iter->second.c_str());
+
+		if (status < 0)
+		{
+			std::cerr << "cache option " << iter->first << "=" << iter->second << ": " << mpv_error_string(status) << std::endl;
+		}
+	}
+
+	const std::map<std::string, std::string>::const_iterator max_bytes = profile.options.find("demuxer-max-bytes");
+
+	uint64_t cache_limit = 0;
+
+	if (max_bytes != profile.options.end())
+	{
+		CacheConfig::parse_size(max_bytes->second, cache_limit);
+	}
+	m_cache_limit.store(cache_limit);
+
+	{
+		std::lock_guard<std::mutex> lock(m_readahead_mutex);
+		m_readahead_file = file_name;
+		m_readahead_size = size;
+		m_readahead_window = profile.readahead;
+		m_readahead_end = 0;
+	}
+	advance_readahead(0.0, 1.0);
+
+	std::cout << "player cache profile " << profile.name << " for " << size << " bytes, readahead " << profile.readahead << " bytes" << std::endl;
+}
+
+/** ask the kernel to read the file ahead of the play position.
+ * The play position in bytes is estimated from the play time, assuming a constant bitrate.
+ * A new window is requested, once less than half of the previous one is left.
+ * @param playtime play position in seconds.
+ * @param duration duration of the file in seconds.
+ */
+void Player::advance_readahead(const double playtime, const double duration)
+{
+	std::lock_guard<std::mutex> lock(m_readahead_mutex);
+
+	if (m_readahead_file.empty() || (m_readahead_window == 0) || (m_readahead_size == 0) || (duration <= 0.0))
+	{
+		return;
+	}
+
+	const double fraction = std::min(1.0, std::max(0.0, playtime / duration));
+	const uint64_t position = static_cast<uint64_t>(fraction * static_cast<double>(m_readahead_size));
+
+	/* after seeking backwards, the hinted range starts at the new position */
+	if (position + m_readahead_window < m_readahead_end)
+	{
+		m_readahead_end = position;
+	}
+
+	if (position + m_readahead_window / readahead_refill < m_readahead_end)
+	{
+		return;
+	}
+
+	const uint64_t start = std::max(position, m_readahead_end);
+	const uint64_t end = std::min(m_readahead_size, position + m_readahead_window);
+
+	if ((end > start) && advise_readahead(m_readahead_file, start, end - start))
+	{
+		m_readahead_end = end;
+	}
+}
+
+/** hint the kernel to read a range of a file into the page cache.
+ * The pages stay cached after the descriptor is closed, so mpv reads them without waiting for the disk.
+ * @param file_name local file, other sources are ignored.
+ * @param offset start of the range in bytes.
+ * @param length length of the range in bytes.
+ * @return flag, whether the hint was given.
+ */
+bool Player::advise_readahead(const std::string& file_name, const uint64_t offset, const uint64_t length)
+{
+	if (length == 0)
+	{
+		return false;
+	}
+
+	const int fd = open(file_name.c_str(), O_RDONLY | O_CLOEXEC);
+
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	const int status = posix_fadvise(fd, static_cast<off_t>(offset), static_cast<off_t>(length), POSIX_FADV_WILLNEED);
+
+	::close(fd);
+	return (status == 0);
+}
+
+/** set the number of texels across the video texture, which are resolvable on the canvas.
+ * mpv renders into a correspondingly smaller target, when the video is larger.
+ * @param width texture width in texels, see Projection::texture_width(), or 0 for the full size.
+ */
+void Player::set_texture_width(const float width)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_wakeup_mutex);
+		m_texture_width = width;
+		m_wakeup.store(true);
+	}
+	m_wakeup_cv.notify_one();
+}
+
+/** number of video frames handed over from the render thread so far.
+ * A changed number indicates a new frame.
+ * @return number of rendered frames.
+ */
+size_t Player::frames(void) const
+{
+	return m_frames.load();
+}
+
+/** find the thumbnail of a position in the video.
+ * @param position time in seconds.
+ * @param first texture coordinates of the top left corner of the thumbnail.
+ * @param last texture coordinates of the bottom right corner of the thumbnail.
+ * @return flag, whether a thumbnail is available to bind_thumbnails().
+ */
+bool Player::thumbnail(const float position, glm::vec2& first, glm::vec2& last) const
+{
+	return (m_thumbnail_texture.size().x > 0) && m_thumbnails.region(static_cast<double>(position), first, last);
+}
+
+float Player::thumbnail_aspect(void) const
+{
+	return m_thumbnails.aspect();
+}
+
+void Player::bind_thumbnails(void) const
+{
+	m_thumbnail_texture.bind();
+}
+
+void Player::unbind_thumbnails(void) const
+{
+	m_thumbnail_texture.unbind();
 }
 
 void Player::bind(void) const
 {
 	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, m_video_texture);
+	glBindTexture(GL_TEXTURE_2D, m_targets[m_display].texture);
 }
 
 void Player::unbind(void) const
@@ -490,11 +1356,7 @@ void Player::unbind(void) const
 
 float Player::volume(void) const
 {
-	double vol = 0.0;
-
-	mpv_get_property(m_context, "ao-volume", MPV_FORMAT_DOUBLE, &vol);
-
-	return static_cast<float>(vol);
+	return static_cast<float>(m_state.volume);
 }
 
 void Player::set_volume(const float vol)
@@ -9,22 +9,67 @@
 #include <glm/glm.hpp>
 #include <GL/gl.h>
 #include <string>
+#include <vector>
 #include <thread>
 #include <mutex>
 #include <atomic>
 #include <condition_variable>
+#include <chrono>
 #include <GLFW/glfw3.h>
+#include "video_target_pool.h"
+#include "keyframe_index.h"
+#include "thumbnail_atlas.h"
+#include "cache_config.h"
+#include "opengl/texture.h"
 
 class Player
 {
+	public:
+		typedef struct
+		{
+			int64_t frame_drops;        /* frames dropped by the video output */
+			int64_t decoder_drops;      /* frames dropped by the decoder */
+			int64_t delayed_frames;     /* frames rendered too late */
+			double avsync;              /* seconds the audio is ahead of the video */
+			double cache_duration;      /* seconds of demuxed data ahead of the play position */
+			int64_t cache_bytes;        /* bytes of demuxed data ahead of the play position */
+			uint64_t cache_limit;       /* maximum bytes of the demuxer cache ahead of the play position */
+			float cache_fill;           /* fraction of the demuxer cache in use */
+			std::string hwdec;          /* hardware decoder in use, "no" for software decoding */
+			double fps;                 /* estimated frame rate of the video */
+			float render_time;          /* average time to render a video frame in milliseconds */
+			float judder;               /* see judder() */
+		}
+		stats_t;
+
 	private:
-		GLuint m_framebuffer;
-		GLuint m_video_texture;
-		double m_playtime;
-		double m_duration;
-		std::string m_title;
-		glm::uvec2 m_size;
+		/* playback state published by the event thread */
+		typedef struct
+		{
+			double playtime;
+			double duration;
+			double volume;
+			glm::uvec2 size;
+			std::string title;
+			bool eof;
+			bool ended;                 /* playback stopped with an error */
+			stats_t stats;
+		}
+		playback_state_t;
+
+		VideoTargetPool m_pool;                 /* used by the render context only */
+		std::vector<VideoTargetPool::target_t> m_targets;
+		unsigned int m_display;                 /* target sampled by the main loop */
+		unsigned int m_write;                   /* target rendered by the render thread */
+		std::atomic<unsigned int> m_ready;      /* latest completed target, handed over between both */
+		std::vector<playback_state_t> m_states;
+		unsigned int m_state_read;              /* state copied by the main loop */
+		unsigned int m_state_write;             /* state written by the event thread */
+		std::atomic<unsigned int> m_state_ready; /* latest complete state, handed over between both */
+		playback_state_t m_state;               /* state used by the main loop */
+		glm::uvec2 m_size;                      /* guarded by the wakeup mutex */
 		bool m_playing;
+		std::atomic<size_t> m_frames;
 
 		std::thread m_render_thread;
 		std::atomic<bool> m_thread_running;
@@ -32,12 +77,53 @@ class Player
 		std::mutex m_wakeup_mutex;
 		std::condition_variable m_wakeup_cv;
 
+		std::thread m_event_thread;
+		std::atomic<bool> m_events_running;
+		bool m_events_pending;
+		std::mutex m_event_mutex;
+		std::condition_variable m_event_cv;
+		std::mutex m_crop_mutex;
+
+		/* texture resolution and display timing of the HMD, guarded by the wakeup mutex */
+		glm::vec2 m_crop;
+		float m_texture_width;
+		bool m_vsync;
+		float m_refresh_rate;
+		int64_t m_display_time;                 /* microseconds in the clock of mpv */
+		uint64_t m_vsync_count;
+		double m_fps;
+		std::atomic<size_t> m_cadence_frames;
+		std::atomic<size_t> m_cadence_breaks;
+		std::atomic<bool> m_cadence_reset;      /* the counters are written by the render thread only */
+
 		GLFWwindow* m_window;
+		GLFWwindow* m_render_window;
 		struct mpv_handle* m_context;
 		struct mpv_render_context* m_render;
+		std::string m_preloaded;                /* file appended to the playlist of mpv */
+		std::chrono::steady_clock::time_point m_open_start;
+		size_t m_open_frames;
+		std::string m_open_kind;                /* kind of the file open awaiting its first frame */
+		KeyframeIndex m_keyframes;
+		double m_scrub_target;                  /* keyframe of the last scrub, negative if none */
+		ThumbnailAtlas m_thumbnails;
+		Texture m_thumbnail_texture;
+		std::atomic<float> m_render_time;       /* milliseconds, written by the render thread */
+		std::chrono::steady_clock::time_point m_stats_logged;
+		CacheConfig m_cache_config;
+		std::atomic<uint64_t> m_cache_limit;    /* demuxer cache size of the current profile */
+
+		/* kernel readahead ahead of the play position, advanced by the event thread */
+		std::mutex m_readahead_mutex;
+		std::string m_readahead_file;
+		uint64_t m_readahead_size;              /* file size in bytes */
+		uint64_t m_readahead_window;            /* bytes to read ahead, 0 to disable */
+		uint64_t m_readahead_end;               /* end of the range hinted so far */
 
 		void render_thread(void);
 		static void thread_starter(Player* player);
+		void event_thread(void);
+		static void event_starter(Player* player);
 		static void on_mpv_events(void* ctx);
 		static void on_render_update(void* ctx);
 
@@ -45,26 +131,52 @@ class Player
 		Player& operator=(const Player&);
 		void start_render_thread(void);
 		void stop_render_thread(void);
-		void render_frame(void);
+		void start_event_thread(void);
+		void stop_event_thread(void);
+		void acquire_frame(void);
+		void process_event(const mpv_event& event, playback_state_t& state);
+		void publish_state(const playback_state_t& state);
+		void init(GLFWwindow* window);
+		void destroy_context(void);
 
 		void set_option(const std::string& key, const std::string& value) const;
+		void apply_crop(void);
+		void apply_cache_profile(const std::string& file_name);
+		void advance_readahead(const double playtime, const double duration);
+		static bool advise_readahead(const std::string& file_name, const uint64_t offset, const uint64_t length);
 
 	public:
 		explicit Player(void);
 		~Player(void);
 
 		void open_file(const std::string& file_name, GLFWwindow* window);
+		void preload(const std::string& file_name);
 		void close(void);
 		void play(void);
 		void pause(void);
 		void stop(void);
 		void jump(const float step);
+		void scrub(const float position);
+		void seek(const float position);
 		void set_volume(const float vol);
 		bool is_playing(void) const;
+		const glm::uvec2& size(void) const;
+		glm::uvec2 render_size(void) const;
+		void set_crop(const glm::vec2& crop);
+		void set_texture_width(const float width);
+		size_t frames(void) const;
 		float duration(void) const;
 		float playtime(void) const;
 		float volume(void) const;
 		void handle_events(void);
+		void vsync(const float refresh_rate, const float display_delay, const uint64_t vsync_count);
+		float judder(void) const;
+		stats_t stats(void) const;
+
+		bool thumbnail(const float position, glm::vec2& first, glm::vec2& last) const;
+		float thumbnail_aspect(void) const;
+		void bind_thumbnails(void) const;
+		void unbind_thumbnails(void) const;
 
 		void bind(void) const;
 		void unbind(void) const;
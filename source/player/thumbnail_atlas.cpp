@@ -0,0 +1,526 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "thumbnail_atlas.h"
+#include "headless_mpv.h"
+
+#include <mpv/render.h>
+#include <sys/stat.h>
+#include <zlib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+
+/* The cache file consists of a header, the path of the video file
+ * and the zlib compressed RGBA pixels of the atlas.
+ * Size and modification time of the video invalidate outdated entries.
+ */
+static const char cache_magic[8] = {'C', 'V', 'R', 'T', 'H', 'U', 'M', 'B'};
+static const uint32_t cache_version = 1;
+
+/* thumbnails in the atlas, evenly spread over the video */
+static const uint32_t thumbnail_count = 100;
+static const uint32_t thumbnail_columns = 10;
+
+/* width of a single thumbnail in pixels, the height follows the aspect of the video */
+static const uint32_t thumbnail_width = 192;
+
+/* limit of the thumbnail height, for videos much higher than wide */
+static const uint32_t max_thumbnail_height = 4 * thumbnail_width;
+
+/* maximum time to wait for a decoded thumbnail */
+static const std::chrono::milliseconds frame_timeout(2000);
+
+typedef struct
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t path_size;
+	uint64_t file_size;
+	int64_t mtime;
+	uint32_t cell_width;
+	uint32_t cell_height;
+	double duration;
+	uint64_t packed_size;
+}
+cache_header_t;
+
+static glm::uvec2 atlas_size(const glm::uvec2& cell)
+{
+	return glm::uvec2(thumbnail_columns * cell.x, ((thumbnail_count + thumbnail_columns - 1) / thumbnail_columns) * cell.y);
+}
+
+/** number of bytes of the RGBA pixels of an atlas.
+ * @param cell size of a single thumbnail in pixels.
+ * @return size in bytes.
+ */
+static size_t atlas_bytes(const glm::uvec2& cell)
+{
+	const glm::uvec2 size = atlas_size(cell);
+
+	return 4 * static_cast<size_t>(size.x) * static_cast<size_t>(size.y);
+}
+
+ThumbnailAtlas::ThumbnailAtlas(void) :
+	m_pixels(),
+	m_cell(0, 0),
+	m_duration(0.0),
+	m_taken(false),
+	m_generation(0),
+	m_request(""),
+	m_requested(false),
+	m_shutdown(false),
+	m_thread(),
+	m_running(false),
+	m_ready(false),
+	m_frame(false),
+	m_frame_mutex(),
+	m_frame_cv(),
+	m_mutex(),
+	m_request_cv()
+{
+}
+
+ThumbnailAtlas::~ThumbnailAtlas(void)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_shutdown = true;
+		cancel();
+	}
+	m_request_cv.notify_all();
+
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+}
+
+/** location of the thumbnail atlases in the user's cache directory. */
+std::string ThumbnailAtlas::default_cache_dir(void)
+{
+	const char* cache = getenv("XDG_CACHE_HOME");
+	const char* home = getenv("HOME");
+
+	if (cache && cache[0])
+	{
+		return std::string(cache) + "/cine-vr/thumbnails";
+	}
+	return std::string(home ? home : "/tmp") + "/.cache/cine-vr/thumbnails";
+}
+
+/** provide the thumbnails of a video file.
+ * The worker thread reads a cached atlas, or renders the thumbnails otherwise.
+ * Only the worker is signalled, so the caller never waits for a previous file.
+ * @param file_name video file.
+ */
+void ThumbnailAtlas::start(const std::string& file_name)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_generation++;
+		m_request = file_name;
+		m_requested = true;
+		m_pixels.clear();
+		m_cell = glm::uvec2(0, 0);
+		m_duration = 0.0;
+		m_taken = false;
+		m_ready.store(false);
+		cancel();
+	}
+	m_request_cv.notify_one();
+
+	if (!m_thread.joinable())
+	{
+		m_thread = std::thread(&ThumbnailAtlas::worker_thread, this);
+	}
+}
+
+/** cancel the file in progress, without waiting for the worker thread.
+ */
+void ThumbnailAtlas::stop(void)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_generation++;
+	m_requested = false;
+	cancel();
+}
+
+/** interrupt the rendering of the worker thread, also while it waits for a frame.
+ */
+void ThumbnailAtlas::cancel(void)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_frame_mutex);
+		m_running.store(false);
+	}
+	m_frame_cv.notify_all();
+}
+
+/** handle the requested files one after another.
+ * Starting another file interrupts the current one.
+ */
+void ThumbnailAtlas::worker_thread(void)
+{
+	std::unique_lock<std::mutex> lk(m_mutex);
+
+	while (true)
+	{
+		m_request_cv.wait(lk, [this]{
+			return m_requested || m_shutdown;
+		});
+
+		if (m_shutdown)
+		{
+			break;
+		}
+
+		const std::string file_name = m_request;
+		const uint64_t generation = m_generation;
+
+		m_requested = false;
+		m_running.store(true);
+		lk.unlock();
+		collect(file_name, generation);
+		lk.lock();
+	}
+}
+
+/** provide the thumbnails of a file from the cache, or by rendering them.
+ * @param file_name video file.
+ * @param generation number of the request, results are dropped when another file was started meanwhile.
+ */
+void ThumbnailAtlas::collect(const std::string& file_name, const uint64_t generation)
+{
+	std::ostringstream cache_file;
+	cache_file << default_cache_dir() << "/" << std::hex << std::hash<std::string>()(file_name) << ".thumb";
+
+	std::vector<uint8_t> pixels;
+	glm::uvec2 cell(0, 0);
+	double duration = 0.0;
+	const bool cached = load(file_name, cache_file.str(), pixels, cell, duration);
+
+	if (!cached)
+	{
+		/* nothing of a cache file, which failed to load, is kept */
+		pixels.clear();
+
+		if (!render(file_name, pixels, cell, duration))
+		{
+			return;
+		}
+		save(file_name, cache_file.str(), pixels, cell, duration);
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (generation == m_generation)
+	{
+		m_pixels.swap(pixels);
+		m_cell = cell;
+		m_duration = duration;
+		m_ready.store(true);
+	}
+}
+
+/** hand the completed atlas over for upload into a texture, once per file.
+ * @param pixels RGBA pixels of the atlas.
+ * @param size width and height of the atlas in pixels.
+ * @return flag, whether a new atlas has been handed over.
+ */
+bool ThumbnailAtlas::take(std::vector<uint8_t>& pixels, glm::uvec2& size)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (!m_ready.load() || m_taken)
+	{
+		return false;
+	}
+
+	pixels = m_pixels;
+	size = atlas_size(m_cell);
+	m_taken = true;
+
+	return true;
+}
+
+/** find the thumbnail showing a time of the video.
+ * @param time time in seconds.
+ * @param first texture coordinates of the top left corner of the thumbnail.
+ * @param last texture coordinates of the bottom right corner of the thumbnail.
+ * @return flag, whether the thumbnails are available.
+ */
+bool ThumbnailAtlas::region(const double time, glm::vec2& first, glm::vec2& last) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (!m_ready.load() || (m_duration <= 0.0))
+	{
+		return false;
+	}
+
+	const double frac = std::min(std::max(time / m_duration, 0.0), 1.0);
+	const uint32_t index = std::min(static_cast<uint32_t>(frac * thumbnail_count), thumbnail_count - 1);
+	const glm::vec2 cell = glm::vec2(m_cell) / glm::vec2(atlas_size(m_cell));
+
+	first = cell * glm::vec2(glm::uvec2(index % thumbnail_columns, index / thumbnail_columns));
+	last = first + cell;
+
+	return true;
+}
+
+/** aspect ratio of the thumbnails.
+ * @return width divided by height.
+ */
+float ThumbnailAtlas::aspect(void) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_cell.y == 0)
+	{
+		return 1.0f;
+	}
+	return static_cast<float>(m_cell.x) / static_cast<float>(m_cell.y);
+}
+
+bool ThumbnailAtlas::load(const std::string& file_name, const std::string& cache_file, std::vector<uint8_t>& pixels, glm::uvec2& cell, double& duration)
+{
+	struct stat sb;
+	struct stat cache_sb;
+
+	if (stat(file_name.c_str(), &sb) || stat(cache_file.c_str(), &cache_sb))
+	{
+		return false;
+	}
+
+	std::ifstream stream(cache_file, std::ios::in | std::ios::binary);
+	cache_header_t header = {};
+
+	/* the sizes are checked before allocating, so a corrupt file is a cache miss */
+	if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+	    !std::equal(cache_magic, cache_magic + sizeof(cache_magic), header.magic) ||
+	    (header.version != cache_version) ||
+	    (header.file_size != static_cast<uint64_t>(sb.st_size)) ||
+	    (header.mtime != sb.st_mtim.tv_sec) ||
+	    (header.path_size != file_name.size()) ||
+	    (header.cell_width != thumbnail_width) ||
+	    (header.cell_height == 0) ||
+	    (header.cell_height > max_thumbnail_height) ||
+	    (header.packed_size > static_cast<uint64_t>(cache_sb.st_size)) ||
+	    (static_cast<uint64_t>(cache_sb.st_size) != sizeof(header) + header.path_size + header.packed_size))
+	{
+		return false;
+	}
+
+	std::string path(header.path_size, '\0');
+	std::vector<uint8_t> packed(header.packed_size);
+
+	cell = glm::uvec2(header.cell_width, header.cell_height);
+	duration = header.duration;
+	pixels.resize(atlas_bytes(cell));
+
+	uLongf unpacked_size = pixels.size();
+
+	return stream.read(&path[0], static_cast<std::streamsize>(path.size())) && (path == file_name) &&
+	       stream.read(reinterpret_cast<char*>(packed.data()), static_cast<std::streamsize>(packed.size())) &&
+	       (uncompress(pixels.data(), &unpacked_size, packed.data(), packed.size()) == Z_OK) &&
+	       (unpacked_size == pixels.size());
+}
+
+void ThumbnailAtlas::save(const std::string& file_name, const std::string& cache_file, const std::vector<uint8_t>& pixels, const glm::uvec2& cell, const double duration)
+{
+	struct stat sb;
+
+	if (stat(file_name.c_str(), &sb))
+	{
+		return;
+	}
+
+	/* create the cache directory including its parents */
+	for (size_t pos = cache_file.find('/', 1); pos != std::string::npos; pos = cache_file.find('/', pos + 1))
+	{
+		mkdir(cache_file.substr(0, pos).c_str(), 0755);
+	}
+
+	std::vector<uint8_t> packed(compressBound(pixels.size()));
+	uLongf packed_size = packed.size();
+
+	if (compress2(packed.data(), &packed_size, pixels.data(), pixels.size(), Z_BEST_SPEED) != Z_OK)
+	{
+		return;
+	}
+
+	cache_header_t header = {};
+	std::copy(cache_magic, cache_magic + sizeof(cache_magic), header.magic);
+	header.version = cache_version;
+	header.path_size = static_cast<uint32_t>(file_name.size());
+	header.file_size = static_cast<uint64_t>(sb.st_size);
+	header.mtime = sb.st_mtim.tv_sec;
+	header.cell_width = cell.x;
+	header.cell_height = cell.y;
+	header.duration = duration;
+	header.packed_size = packed_size;
+
+	/* the complete file replaces an existing one, so readers never see a partial atlas */
+	const std::string temp_file = cache_file + ".tmp";
+	bool success = false;
+
+	{
+		std::ofstream stream(temp_file, std::ios::out | std::ios::binary | std::ios::trunc);
+
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		stream.write(file_name.data(), static_cast<std::streamsize>(file_name.size()));
+		stream.write(reinterpret_cast<const char*>(packed.data()), static_cast<std::streamsize>(packed_size));
+		success = stream.good();
+	}
+
+	if (!success || rename(temp_file.c_str(), cache_file.c_str()))
+	{
+		std::cerr << "could not write thumbnails " << cache_file << std::endl;
+		remove(temp_file.c_str());
+	}
+}
+
+void ThumbnailAtlas::on_render_update(void* ctx)
+{
+	ThumbnailAtlas* self = static_cast<ThumbnailAtlas*>(ctx);
+
+	if (self)
+	{
+		{
+			std::lock_guard<std::mutex> lock(self->m_frame_mutex);
+			self->m_frame = true;
+		}
+		self->m_frame_cv.notify_one();
+	}
+}
+
+/** wait for mpv to provide a new frame to render.
+ * @return flag, whether a frame is available.
+ */
+bool ThumbnailAtlas::wait_for_frame(void)
+{
+	std::unique_lock<std::mutex> lk(m_frame_mutex);
+
+	m_frame_cv.wait_for(lk, frame_timeout, [this]{
+		return m_frame || !m_running.load();
+	});
+
+	const bool frame = m_frame && m_running.load();
+	m_frame = false;
+
+	return frame;
+}
+
+/** render the thumbnails with a headless mpv instance.
+ * mpv decodes keyframes only and scales them in software directly into the cells of the atlas,
+ * neither the OpenGL context nor the decoder of the playback are used.
+ * @param file_name video file.
+ * @param pixels RGBA pixels of the atlas.
+ * @param cell size of a single thumbnail in pixels.
+ * @param duration duration of the video in seconds.
+ * @return flag, whether all thumbnails were rendered.
+ */
+bool ThumbnailAtlas::render(const std::string& file_name, std::vector<uint8_t>& pixels, glm::uvec2& cell, double& duration)
+{
+	mpv_handle* mpv = headless_mpv_create("libmpv");
+
+	if (!mpv)
+	{
+		return false;
+	}
+
+	mpv_render_param params[] = {
+		{MPV_RENDER_PARAM_API_TYPE, const_cast<char*>(MPV_RENDER_API_TYPE_SW)},
+		{MPV_RENDER_PARAM_INVALID, nullptr}
+	};
+
+	mpv_render_context* render = nullptr;
+	std::vector<const char*> load_cmd = {"loadfile", file_name.c_str(), nullptr};
+	bool complete = false;
+
+	if (mpv_render_context_create(&render, mpv, params) >= 0)
+	{
+		mpv_render_context_set_update_callback(render, on_render_update, this);
+
+		int64_t width = 0;
+		int64_t height = 0;
+
+		if ((mpv_command(mpv, load_cmd.data()) >= 0) &&
+		    (headless_mpv_wait(mpv, m_running) == MPV_EVENT_PLAYBACK_RESTART) &&
+		    (mpv_get_property(mpv, "duration", MPV_FORMAT_DOUBLE, &duration) >= 0) &&
+		    (mpv_get_property(mpv, "dwidth", MPV_FORMAT_INT64, &width) >= 0) &&
+		    (mpv_get_property(mpv, "dheight", MPV_FORMAT_INT64, &height) >= 0) &&
+		    (duration > 0.0) && (width > 0) && (height > 0))
+		{
+			cell = glm::uvec2(thumbnail_width, static_cast<uint32_t>(std::min<int64_t>(max_thumbnail_height, std::max<int64_t>(1, (thumbnail_width * height) / width))));
+
+			size_t stride = 4 * static_cast<size_t>(atlas_size(cell).x);
+			int sw_size[2] = {static_cast<int>(cell.x), static_cast<int>(cell.y)};
+			char sw_format[] = "rgb0";
+
+			pixels.resize(atlas_bytes(cell), 0);
+			complete = true;
+
+			for (uint32_t i = 0; complete && (i < thumbnail_count); i++)
+			{
+				std::ostringstream s;
+				s << std::fixed << std::setprecision(3) << ((i + 0.5) * duration / thumbnail_count);
+				const std::string t = s.str();
+
+				std::vector<const char*> seek_cmd = {"seek", t.c_str(), "absolute+keyframes", nullptr};
+
+				/* an update of the previous position must not be taken for the frame after the seek */
+				{
+					std::lock_guard<std::mutex> lock(m_frame_mutex);
+					m_frame = false;
+				}
+
+				complete = (mpv_command(mpv, seek_cmd.data()) >= 0) &&
+				           (headless_mpv_wait(mpv, m_running) != MPV_EVENT_NONE);
+
+				/* updates without a new video frame are skipped */
+				bool frame = false;
+
+				while (complete && !frame)
+				{
+					complete = wait_for_frame();
+					frame = complete && ((mpv_render_context_update(render) & MPV_RENDER_UPDATE_FRAME) != 0);
+				}
+
+				if (complete)
+				{
+					uint8_t* pointer = pixels.data() + (i / thumbnail_columns) * cell.y * stride + 4 * (i % thumbnail_columns) * cell.x;
+					mpv_render_param params_sw[] = {
+						{MPV_RENDER_PARAM_SW_SIZE, sw_size},
+						{MPV_RENDER_PARAM_SW_FORMAT, sw_format},
+						{MPV_RENDER_PARAM_SW_STRIDE, &stride},
+						{MPV_RENDER_PARAM_SW_POINTER, pointer},
+						{MPV_RENDER_PARAM_INVALID, nullptr}
+					};
+
+					mpv_render_context_render(render, params_sw);
+				}
+			}
+		}
+		mpv_render_context_set_update_callback(render, nullptr, nullptr);
+		mpv_render_context_free(render);
+	}
+	mpv_terminate_destroy(mpv);
+
+	if (complete)
+	{
+		/* the padding byte of mpv becomes an opaque alpha channel */
+		for (size_t i = 3; i < pixels.size(); i += 4)
+		{
+			pixels[i] = 0xFF;
+		}
+	}
+	return complete;
+}
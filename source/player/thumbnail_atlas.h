@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef THUMBNAIL_ATLAS_H
+#define THUMBNAIL_ATLAS_H
+
+#include <glm/glm.hpp>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+class ThumbnailAtlas
+{
+	private:
+		std::vector<uint8_t> m_pixels;  /* RGBA, thumbnails in rows from the start of the video */
+		glm::uvec2 m_cell;              /* size of a single thumbnail in pixels */
+		double m_duration;
+		bool m_taken;
+		uint64_t m_generation;          /* counts the started files, results of previous files are dropped */
+		std::string m_request;          /* file waiting for the worker thread */
+		bool m_requested;
+		bool m_shutdown;
+		std::thread m_thread;
+		std::atomic<bool> m_running;    /* the file of the worker thread is still wanted */
+		std::atomic<bool> m_ready;
+		bool m_frame;
+		std::mutex m_frame_mutex;
+		std::condition_variable m_frame_cv;
+		mutable std::mutex m_mutex;
+		std::condition_variable m_request_cv;
+
+		ThumbnailAtlas(const ThumbnailAtlas&);
+		ThumbnailAtlas& operator=(const ThumbnailAtlas&);
+
+		static bool load(const std::string& file_name, const std::string& cache_file, std::vector<uint8_t>& pixels, glm::uvec2& cell, double& duration);
+		static void save(const std::string& file_name, const std::string& cache_file, const std::vector<uint8_t>& pixels, const glm::uvec2& cell, const double duration);
+		void cancel(void);
+		bool wait_for_frame(void);
+		bool render(const std::string& file_name, std::vector<uint8_t>& pixels, glm::uvec2& cell, double& duration);
+		void collect(const std::string& file_name, const uint64_t generation);
+		void worker_thread(void);
+		static void on_render_update(void* ctx);
+
+	public:
+		explicit ThumbnailAtlas(void);
+		~ThumbnailAtlas(void);
+
+		static std::string default_cache_dir(void);
+
+		void start(const std::string& file_name);
+		void stop(void);
+		bool take(std::vector<uint8_t>& pixels, glm::uvec2& size);
+		bool region(const double time, glm::vec2& first, glm::vec2& last) const;
+		float aspect(void) const;
+};
+
+#endif
@@ -0,0 +1,141 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#define GL_GLEXT_PROTOTYPES
+
+#include "video_target_pool.h"
+#include <iostream>
+
+/** create an empty pool.
+ * All methods must be called with the OpenGL context current, which owns the framebuffers.
+ * @param budget video memory in bytes, above which released targets are freed.
+ */
+VideoTargetPool::VideoTargetPool(const size_t budget) :
+	m_free(),
+	m_budget(budget),
+	m_bytes(0),
+	m_allocations(0),
+	m_reuses(0)
+{
+}
+
+VideoTargetPool::~VideoTargetPool(void)
+{
+}
+
+/** video memory of a target.
+ * @param size size of the target in pixels.
+ * @return size in bytes.
+ */
+size_t VideoTargetPool::bytes(const glm::uvec2& size)
+{
+	return static_cast<size_t>(size.x) * size.y * 4;
+}
+
+/** delete the framebuffer and texture of a target.
+ * @param target target to delete.
+ */
+void VideoTargetPool::remove(const target_t& target)
+{
+	glDeleteFramebuffers(1, &target.framebuffer);
+	glDeleteTextures(1, &target.texture);
+}
+
+/** get a render target of the given size.
+ * A released target of the same size is reused, otherwise a new one with immutable storage is allocated.
+ * @param size size of the target in pixels.
+ * @return framebuffer and texture of the target.
+ */
+VideoTargetPool::target_t VideoTargetPool::acquire(const glm::uvec2& size)
+{
+	for (std::list<target_t>::iterator iter = m_free.begin(); iter != m_free.end(); ++iter)
+	{
+		if (iter->size == size)
+		{
+			const target_t target = *iter;
+			m_free.erase(iter);
+			m_reuses++;
+			return target;
+		}
+	}
+
+	target_t target = {0, 0, size};
+
+	glGenTextures(1, &target.texture);
+	glBindTexture(GL_TEXTURE_2D, target.texture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, static_cast<GLsizei>(size.x), static_cast<GLsizei>(size.y));
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	glGenFramebuffers(1, &target.framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.texture, 0);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "failed creating framebuffer" << std::endl;
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	m_bytes += bytes(size);
+	m_allocations++;
+	trim();
+	return target;
+}
+
+/** hand a target back to the pool for later reuse.
+ * @param target target, which is no longer rendered to or sampled from.
+ */
+void VideoTargetPool::release(const target_t& target)
+{
+	if (!target.texture)
+	{
+		return;
+	}
+	m_free.push_front(target);
+	trim();
+}
+
+/** free the least recently released targets, until the budget is met.
+ */
+void VideoTargetPool::trim(void)
+{
+	while ((m_bytes > m_budget) && !m_free.empty())
+	{
+		const target_t& target = m_free.back();
+
+		m_bytes -= bytes(target.size);
+		remove(target);
+		m_free.pop_back();
+	}
+}
+
+/** free all released targets.
+ */
+void VideoTargetPool::clear(void)
+{
+	for (std::list<target_t>::const_iterator iter = m_free.begin(); iter != m_free.end(); ++iter)
+	{
+		m_bytes -= bytes(iter->size);
+		remove(*iter);
+	}
+	m_free.clear();
+}
+
+/** number of targets allocated so far.
+ * @return number of allocations.
+ */
+size_t VideoTargetPool::allocations(void) const
+{
+	return m_allocations.load();
+}
+
+/** number of targets taken from the pool instead of allocating them.
+ * @return number of avoided allocations.
+ */
+size_t VideoTargetPool::reuses(void) const
+{
+	return m_reuses.load();
+}
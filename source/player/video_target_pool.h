@@ -0,0 +1,49 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef VIDEO_TARGET_POOL_H
+#define VIDEO_TARGET_POOL_H
+
+#include <GL/gl.h>
+#include <glm/glm.hpp>
+#include <list>
+#include <atomic>
+
+class VideoTargetPool
+{
+	public:
+		typedef struct
+		{
+			GLuint framebuffer;     /* owned by the render context, framebuffers are not shared */
+			GLuint texture;         /* shared between the render and the main context */
+			glm::uvec2 size;
+		}
+		target_t;
+
+		explicit VideoTargetPool(const size_t budget);
+		~VideoTargetPool(void);
+
+		target_t acquire(const glm::uvec2& size);
+		void release(const target_t& target);
+		void clear(void);
+
+		size_t allocations(void) const;
+		size_t reuses(void) const;
+
+	private:
+		std::list<target_t> m_free;       // most recently released first
+		size_t m_budget;
+		size_t m_bytes;
+		std::atomic<size_t> m_allocations;
+		std::atomic<size_t> m_reuses;
+
+		VideoTargetPool(const VideoTargetPool&);
+		VideoTargetPool& operator=(const VideoTargetPool&);
+
+		static size_t bytes(const glm::uvec2& size);
+		static void remove(const target_t& target);
+		void trim(void);
+};
+
+#endif
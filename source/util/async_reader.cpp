@@ -0,0 +1,553 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "async_reader.h"
+
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#include <algorithm>
+#include <iostream>
+
+static const size_t pool_size = 4;                      // threads of the fallback without io_uring
+static const size_t max_read_size = 64 * 1024 * 1024;   // bytes per single read operation
+
+static int sys_io_uring_setup(const unsigned int entries, struct io_uring_params* params)
+{
+	return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int sys_io_uring_enter(const int fd, const unsigned int to_submit, const unsigned int min_complete, const unsigned int flags)
+{
+	return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+static unsigned int* ring_field(void* ring, const uint32_t offset)
+{
+	return static_cast<unsigned int*>(static_cast<void*>(static_cast<uint8_t*>(ring) + offset));
+}
+
+AsyncReader::AsyncReader(void) :
+	m_ring_fd(-1),
+	m_ring_entries(0),
+	m_sq_ptr(MAP_FAILED),
+	m_sq_size(0),
+	m_cq_ptr(MAP_FAILED),
+	m_cq_size(0),
+	m_sqes(MAP_FAILED),
+	m_sqes_size(0),
+	m_sq_head(nullptr),
+	m_sq_tail(nullptr),
+	m_sq_mask(nullptr),
+	m_sq_array(nullptr),
+	m_cq_head(nullptr),
+	m_cq_tail(nullptr),
+	m_cq_mask(nullptr),
+	m_cqes(nullptr),
+	m_queued(0),
+	m_in_flight(0),
+	m_requests(),
+	m_pending(),
+	m_threads(),
+	m_running(false),
+	m_mutex(),
+	m_submit_cv(),
+	m_done_cv()
+{
+}
+
+AsyncReader::~AsyncReader(void)
+{
+	stop();
+}
+
+/** start the reader threads.
+ * io_uring is used, if the kernel provides it (Linux 5.6 or newer).
+ * Otherwise, a small pool of threads issues blocking reads in parallel.
+ * @param queue_depth maximum number of operations in flight.
+ */
+void AsyncReader::start(const unsigned int queue_depth)
+{
+	if (!m_threads.empty())
+	{
+		return;
+	}
+
+	m_running.store(true);
+
+	if (setup_ring(queue_depth))
+	{
+		m_threads.push_back(std::thread(&AsyncReader::ring_thread, this));
+	}
+	else
+	{
+		for (size_t i = 0; i < pool_size; i++)
+		{
+			m_threads.push_back(std::thread(&AsyncReader::pool_thread, this));
+		}
+	}
+}
+
+void AsyncReader::stop(void)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_running.store(false);
+	}
+	m_submit_cv.notify_all();
+
+	for (std::vector<std::thread>::iterator iter = m_threads.begin(); iter != m_threads.end(); ++iter)
+	{
+		if (iter->joinable())
+		{
+			iter->join();
+		}
+	}
+	m_threads.clear();
+	teardown_ring();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	for (std::list<request_t>::iterator iter = m_requests.begin(); iter != m_requests.end(); ++iter)
+	{
+		if (iter->fd >= 0)
+		{
+			::close(iter->fd);
+		}
+	}
+	m_requests.clear();
+	m_pending.clear();
+	m_done_cv.notify_all();
+}
+
+bool AsyncReader::setup_ring(const unsigned int queue_depth)
+{
+	struct io_uring_params params;
+
+	memset(&params, 0, sizeof(params));
+	m_ring_fd = sys_io_uring_setup(queue_depth, &params);
+
+	if (m_ring_fd < 0)
+	{
+		std::cout << "io_uring not available, using thread pool for file reading" << std::endl;
+		return false;
+	}
+
+	/* IORING_OP_READ was added together with this feature flag */
+	if (!(params.features & IORING_FEAT_RW_CUR_POS))
+	{
+		std::cout << "io_uring too old, using thread pool for file reading" << std::endl;
+		teardown_ring();
+		return false;
+	}
+
+	m_ring_entries = params.sq_entries;
+	m_sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+	m_cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	m_sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+	if (params.features & IORING_FEAT_SINGLE_MMAP)
+	{
+		m_sq_size = std::max(m_sq_size, m_cq_size);
+	}
+
+	m_sq_ptr = mmap(nullptr, m_sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_SQ_RING);
+
+	if (params.features & IORING_FEAT_SINGLE_MMAP)
+	{
+		m_cq_size = 0;
+	}
+	else
+	{
+		m_cq_ptr = mmap(nullptr, m_cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_CQ_RING);
+	}
+	m_sqes = mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_SQES);
+
+	void* cq_ptr = (m_cq_size == 0) ? m_sq_ptr : m_cq_ptr;
+
+	if ((m_sq_ptr == MAP_FAILED) || (cq_ptr == MAP_FAILED) || (m_sqes == MAP_FAILED))
+	{
+		std::cout << "failed mapping io_uring, using thread pool for file reading" << std::endl;
+		teardown_ring();
+		return false;
+	}
+
+	m_sq_head = ring_field(m_sq_ptr, params.sq_off.head);
+	m_sq_tail = ring_field(m_sq_ptr, params.sq_off.tail);
+	m_sq_mask = ring_field(m_sq_ptr, params.sq_off.ring_mask);
+	m_sq_array = ring_field(m_sq_ptr, params.sq_off.array);
+	m_cq_head = ring_field(cq_ptr, params.cq_off.head);
+	m_cq_tail = ring_field(cq_ptr, params.cq_off.tail);
+	m_cq_mask = ring_field(cq_ptr, params.cq_off.ring_mask);
+	m_cqes = ring_field(cq_ptr, params.cq_off.cqes);
+	m_queued = 0;
+	m_in_flight = 0;
+	return true;
+}
+
+void AsyncReader::teardown_ring(void)
+{
+	if (m_sqes != MAP_FAILED)
+	{
+		munmap(m_sqes, m_sqes_size);
+		m_sqes = MAP_FAILED;
+	}
+
+	if (m_cq_ptr != MAP_FAILED)
+	{
+		munmap(m_cq_ptr, m_cq_size);
+		m_cq_ptr = MAP_FAILED;
+	}
+
+	if (m_sq_ptr != MAP_FAILED)
+	{
+		munmap(m_sq_ptr, m_sq_size);
+		m_sq_ptr = MAP_FAILED;
+	}
+
+	if (m_ring_fd >= 0)
+	{
+		::close(m_ring_fd);
+		m_ring_fd = -1;
+	}
+}
+
+/** reserve the next free submission queue entry.
+ * Only the ring thread produces entries, so the tail needs no atomic increment.
+ */
+void* AsyncReader::next_sqe(void)
+{
+	const unsigned int tail = *m_sq_tail + m_queued;
+	const unsigned int index = tail & *m_sq_mask;
+	struct io_uring_sqe* sqe = static_cast<struct io_uring_sqe*>(m_sqes) + index;
+
+	memset(sqe, 0, sizeof(*sqe));
+	m_sq_array[index] = index;
+	m_queued++;
+	m_in_flight++;
+	return sqe;
+}
+
+void AsyncReader::submit_read(request_t& request)
+{
+	struct io_uring_sqe* sqe = static_cast<struct io_uring_sqe*>(next_sqe());
+	const size_t length = std::min(request.data.size() - request.offset, max_read_size);
+
+	sqe->opcode = IORING_OP_READ;
+	sqe->fd = request.fd;
+	sqe->addr = reinterpret_cast<uintptr_t>(request.data.data() + request.offset);
+	sqe->len = static_cast<uint32_t>(length);
+	sqe->off = request.offset;
+	sqe->user_data = reinterpret_cast<uintptr_t>(&request);
+}
+
+/** prepare a request for submission to the ring.
+ * Opening a file and querying its size is done synchronously,
+ * the actual data transfer is done asynchronously.
+ * @return flag, whether an operation was queued.
+ */
+bool AsyncReader::queue_request(request_t& request)
+{
+	request.fd = open(request.file_name.c_str(), O_RDONLY | O_CLOEXEC);
+
+	if (request.fd < 0)
+	{
+		finish_request(request, errno);
+		return false;
+	}
+
+	struct stat sb;
+
+	if (fstat(request.fd, &sb))
+	{
+		finish_request(request, errno);
+		return false;
+	}
+
+	request.data.resize(static_cast<size_t>(sb.st_size));
+
+	if (request.data.empty())
+	{
+		finish_request(request, 0);
+		return false;
+	}
+
+	posix_fadvise(request.fd, 0, sb.st_size, POSIX_FADV_SEQUENTIAL);
+	submit_read(request);
+	return true;
+}
+
+void AsyncReader::reap_completions(void)
+{
+	unsigned int head = *m_cq_head;
+
+	while (head != __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE))
+	{
+		const struct io_uring_cqe* cqe = static_cast<const struct io_uring_cqe*>(m_cqes) + (head & *m_cq_mask);
+		request_t& request = *reinterpret_cast<request_t*>(static_cast<uintptr_t>(cqe->user_data));
+		const int result = cqe->res;
+
+		head++;
+		m_in_flight--;
+
+		if ((result == -EINTR) || (result == -EAGAIN))
+		{
+			submit_read(request);
+		}
+		else if (result < 0)
+		{
+			finish_request(request, -result);
+		}
+		else if (result == 0)
+		{
+			/* file was truncated while reading */
+			request.data.resize(request.offset);
+			finish_request(request, 0);
+		}
+		else
+		{
+			request.offset += static_cast<size_t>(result);
+
+			if (request.offset < request.data.size())
+			{
+				submit_read(request);
+			}
+			else
+			{
+				finish_request(request, 0);
+			}
+		}
+	}
+	__atomic_store_n(m_cq_head, head, __ATOMIC_RELEASE);
+}
+
+void AsyncReader::finish_request(request_t& request, const int error)
+{
+	if (request.fd >= 0)
+	{
+		::close(request.fd);
+		request.fd = -1;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	request.error = error;
+	request.done = true;
+
+	if (!request.wanted)
+	{
+		m_requests.remove_if([&request](const request_t& r){
+			return &r == &request;
+		});
+	}
+	m_done_cv.notify_all();
+}
+
+void AsyncReader::ring_thread(void)
+{
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_submit_cv.wait(lock, [this]{
+				return !m_pending.empty() || (m_in_flight > 0) || !m_running.load();
+			});
+
+			if (!m_running.load() && (m_in_flight == 0))
+			{
+				break;
+			}
+
+			/* move as many requests into the ring as it can take, to keep the device queue full */
+			while (m_running.load() && !m_pending.empty() && (m_in_flight < m_ring_entries))
+			{
+				request_t* request = m_pending.front();
+				m_pending.pop_front();
+				lock.unlock();
+				queue_request(*request);
+				lock.lock();
+			}
+		}
+
+		const unsigned int queued = m_queued;
+
+		/* publish the new entries to the kernel */
+		__atomic_store_n(m_sq_tail, *m_sq_tail + queued, __ATOMIC_RELEASE);
+		m_queued = 0;
+
+		/* block for completions only, if there is nothing new to submit */
+		const unsigned int min_complete = ((queued == 0) && (m_in_flight > 0)) ? 1 : 0;
+		const int status = sys_io_uring_enter(m_ring_fd, queued, min_complete, IORING_ENTER_GETEVENTS);
+
+		if ((status < 0) && (errno != EINTR))
+		{
+			std::cerr << "io_uring_enter failed: " << strerror(errno) << std::endl;
+		}
+		reap_completions();
+	}
+}
+
+void AsyncReader::pool_thread(void)
+{
+	while (true)
+	{
+		request_t* request = nullptr;
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_submit_cv.wait(lock, [this]{
+				return !m_pending.empty() || !m_running.load();
+			});
+
+			if (!m_running.load())
+			{
+				break;
+			}
+			request = m_pending.front();
+			m_pending.pop_front();
+		}
+
+		process_blocking(*request);
+		finish_request(*request, request->error);
+	}
+}
+
+void AsyncReader::process_blocking(request_t& request) const
+{
+	request.fd = open(request.file_name.c_str(), O_RDONLY | O_CLOEXEC);
+
+	if (request.fd < 0)
+	{
+		request.error = errno;
+		return;
+	}
+
+	struct stat sb;
+
+	if (fstat(request.fd, &sb))
+	{
+		request.error = errno;
+		return;
+	}
+
+	request.data.resize(static_cast<size_t>(sb.st_size));
+	posix_fadvise(request.fd, 0, sb.st_size, POSIX_FADV_SEQUENTIAL);
+
+	while (request.offset < request.data.size())
+	{
+		const ssize_t result = pread(request.fd, request.data.data() + request.offset, request.data.size() - request.offset, static_cast<off_t>(request.offset));
+
+		if ((result < 0) && (errno == EINTR))
+		{
+			continue;
+		}
+
+		if (result < 0)
+		{
+			request.error = errno;
+			return;
+		}
+
+		if (result == 0)
+		{
+			request.data.resize(request.offset);
+			break;
+		}
+		request.offset += static_cast<size_t>(result);
+	}
+	request.error = 0;
+}
+
+void AsyncReader::enqueue(request_t& request)
+{
+	m_pending.push_back(&request);
+}
+
+/** request files to be read in the background.
+ * Buffers of previously requested files, which are not in the given list, are dropped.
+ * @param file_names files expected to be opened soon.
+ */
+void AsyncReader::prefetch(const std::vector<std::string>& file_names)
+{
+	if (m_threads.empty())
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	for (std::list<request_t>::iterator iter = m_requests.begin(); iter != m_requests.end();)
+	{
+		const bool keep = (std::find(file_names.begin(), file_names.end(), iter->file_name) != file_names.end());
+
+		if (!keep && iter->done)
+		{
+			iter = m_requests.erase(iter);
+			continue;
+		}
+
+		if (!keep)
+		{
+			/* buffer is released on completion */
+			iter->wanted = false;
+		}
+		++iter;
+	}
+
+	for (std::vector<std::string>::const_iterator name = file_names.begin(); name != file_names.end(); ++name)
+	{
+		std::list<request_t>::const_iterator iter = std::find_if(m_requests.begin(), m_requests.end(), [&name](const request_t& r){
+			return r.wanted && (r.file_name == *name);
+		});
+
+		if (iter == m_requests.end())
+		{
+			m_requests.push_back(request_t{*name, -1, 0, 0, false, true, std::vector<uint8_t>()});
+			enqueue(m_requests.back());
+		}
+	}
+	m_submit_cv.notify_all();
+}
+
+/** take the content of a prefetched file.
+ * @param file_name file, which has been passed to prefetch() before.
+ * @param data content of the file.
+ * @param wait flag to wait for a read in progress.
+ * @return flag, whether the content is available. If not, the file needs to be read directly.
+ */
+bool AsyncReader::fetch(const std::string& file_name, std::vector<uint8_t>& data, const bool wait)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	std::list<request_t>::iterator iter = std::find_if(m_requests.begin(), m_requests.end(), [&file_name](const request_t& r){
+		return r.wanted && (r.file_name == file_name);
+	});
+
+	if (iter == m_requests.end())
+	{
+		return false;
+	}
+
+	if (!iter->done && !wait)
+	{
+		return false;
+	}
+
+	m_done_cv.wait(lock, [&iter]{
+		return iter->done;
+	});
+
+	const bool success = (iter->error == 0);
+
+	if (success)
+	{
+		data.swap(iter->data);
+	}
+	m_requests.erase(iter);
+	return success;
+}
@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef ASYNC_READER_H
+#define ASYNC_READER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <list>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+class AsyncReader
+{
+	public:
+		explicit AsyncReader(void);
+		~AsyncReader(void);
+
+		void start(const unsigned int queue_depth = 32);
+		void stop(void);
+
+		void prefetch(const std::vector<std::string>& file_names);
+		bool fetch(const std::string& file_name, std::vector<uint8_t>& data, const bool wait);
+
+	private:
+		typedef struct
+		{
+			std::string file_name;
+			int fd;
+			int error;
+			size_t offset;
+			bool done;
+			bool wanted;
+			std::vector<uint8_t> data;
+		}
+		request_t;
+
+		/* io_uring submission and completion rings, mapped from the kernel */
+		int m_ring_fd;
+		unsigned int m_ring_entries;
+		void* m_sq_ptr;
+		size_t m_sq_size;
+		void* m_cq_ptr;
+		size_t m_cq_size;
+		void* m_sqes;
+		size_t m_sqes_size;
+		unsigned int* m_sq_head;
+		unsigned int* m_sq_tail;
+		unsigned int* m_sq_mask;
+		unsigned int* m_sq_array;
+		unsigned int* m_cq_head;
+		unsigned int* m_cq_tail;
+		unsigned int* m_cq_mask;
+		void* m_cqes;
+		unsigned int m_queued;
+		unsigned int m_in_flight;
+
+		std::list<request_t> m_requests;
+		std::deque<request_t*> m_pending;
+		std::vector<std::thread> m_threads;
+		std::atomic<bool> m_running;
+		std::mutex m_mutex;
+		std::condition_variable m_submit_cv;
+		std::condition_variable m_done_cv;
+
+		AsyncReader(const AsyncReader&);
+		AsyncReader& operator=(const AsyncReader&);
+
+		bool setup_ring(const unsigned int queue_depth);
+		void teardown_ring(void);
+		void* next_sqe(void);
+		bool queue_request(request_t& request);
+		void submit_read(request_t& request);
+		void reap_completions(void);
+		void finish_request(request_t& request, const int error);
+
+		void ring_thread(void);
+		void pool_thread(void);
+		void process_blocking(request_t& request) const;
+		void enqueue(request_t& request);
+};
+
+#endif
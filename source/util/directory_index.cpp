@@ -0,0 +1,258 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "directory_index.h"
+#include "file_system.h"
+
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <linux/limits.h>
+#include <errno.h>
+#include <string.h>
+#include <algorithm>
+#include <iostream>
+
+static const uint32_t watch_mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+
+DirectoryIndex::DirectoryIndex(void) :
+	m_directory(),
+	m_files(),
+	m_position(0),
+	m_inotify_fd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)),
+	m_watch(-1),
+	m_valid(false)
+{
+	if (m_inotify_fd < 0)
+	{
+		std::cerr << "inotify not available, directories are rescanned on every step" << std::endl;
+	}
+}
+
+DirectoryIndex::~DirectoryIndex(void)
+{
+	unwatch();
+
+	if (m_inotify_fd >= 0)
+	{
+		close(m_inotify_fd);
+	}
+}
+
+void DirectoryIndex::unwatch(void)
+{
+	if (m_watch >= 0)
+	{
+		inotify_rm_watch(m_inotify_fd, m_watch);
+		m_watch = -1;
+	}
+	m_valid = false;
+}
+
+/** read the media files of a directory and start watching it for changes.
+ * Directories inside archives can not be watched, they do not change while browsing.
+ * @param directory directory to index.
+ */
+void DirectoryIndex::load(const std::string& directory)
+{
+	FileSystem fs;
+	std::string archive;
+	std::string member;
+
+	unwatch();
+	m_directory = directory;
+	m_files.clear();
+	m_position = 0;
+
+	const bool in_archive = fs.split_archive_path(directory, archive, member);
+
+	/* watch before scanning, so no change between both gets lost */
+	if ((m_inotify_fd >= 0) && !in_archive)
+	{
+		m_watch = inotify_add_watch(m_inotify_fd, directory.c_str(), watch_mask | IN_ONLYDIR);
+	}
+
+	const std::vector<FileSystem::directory_entry_t> entries = fs.scan_directory(directory, false);
+
+	for (std::vector<FileSystem::directory_entry_t>::const_iterator iter = entries.begin(); iter != entries.end(); ++iter)
+	{
+		if (!iter->is_directory)
+		{
+			m_files.push_back(iter->name);
+		}
+	}
+	m_valid = in_archive || (m_watch >= 0);
+}
+
+/** apply pending changes of the watched directory to the index. */
+void DirectoryIndex::process_events(void)
+{
+	if (m_watch < 0)
+	{
+		return;
+	}
+
+	std::vector<char> buffer(16 * (sizeof(struct inotify_event) + NAME_MAX + 1));
+
+	while (true)
+	{
+		const ssize_t length = read(m_inotify_fd, buffer.data(), buffer.size());
+
+		if (length <= 0)
+		{
+			if ((length < 0) && (errno != EAGAIN) && (errno != EINTR))
+			{
+				std::cerr << "reading inotify events failed: " << strerror(errno) << std::endl;
+				m_valid = false;
+			}
+			break;
+		}
+
+		for (ssize_t offset = 0; offset < length;)
+		{
+			struct inotify_event event;
+
+			memcpy(&event, buffer.data() + offset, sizeof(event));
+
+			const std::string name(buffer.data() + offset + sizeof(event), strnlen(buffer.data() + offset + sizeof(event), event.len));
+
+			offset += static_cast<ssize_t>(sizeof(event) + event.len);
+
+			if (event.mask & IN_Q_OVERFLOW)
+			{
+				/* events got lost, only a rescan recovers */
+				m_valid = false;
+			}
+			else if (event.wd != m_watch)
+			{
+				/* stale event of a previously watched directory */
+			}
+			else if (event.mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED))
+			{
+				m_valid = false;
+			}
+			else if (event.mask & IN_ISDIR)
+			{
+			}
+			else if (event.mask & (IN_CREATE | IN_MOVED_TO))
+			{
+				insert(name);
+			}
+			else if (event.mask & (IN_DELETE | IN_MOVED_FROM))
+			{
+				remove(name);
+			}
+		}
+	}
+}
+
+void DirectoryIndex::insert(const std::string& name)
+{
+	FileSystem fs;
+	const std::string ext = fs.extension(name);
+
+	if ((name.empty()) || (name[0] == '.') || !(fs.is_image(ext) || fs.is_video(ext)))
+	{
+		return;
+	}
+
+	std::vector<std::string>::iterator iter = std::lower_bound(m_files.begin(), m_files.end(), name);
+
+	if ((iter != m_files.end()) && (*iter == name))
+	{
+		return;
+	}
+
+	const size_t index = static_cast<size_t>(iter - m_files.begin());
+
+	m_files.insert(iter, name);
+
+	if ((index <= m_position) && (m_files.size() > 1))
+	{
+		m_position++;
+	}
+}
+
+void DirectoryIndex::remove(const std::string& name)
+{
+	std::vector<std::string>::iterator iter = std::lower_bound(m_files.begin(), m_files.end(), name);
+
+	if ((iter == m_files.end()) || (*iter != name))
+	{
+		return;
+	}
+
+	const size_t index = static_cast<size_t>(iter - m_files.begin());
+
+	m_files.erase(iter);
+
+	if ((index < m_position) || ((m_position > 0) && (m_position >= m_files.size())))
+	{
+		m_position--;
+	}
+}
+
+/** set the current position to a file of the index.
+ * The last position is checked first, so stepping through a directory needs no search.
+ * @param name name of the file inside the indexed directory.
+ * @return flag, whether the file is part of the index.
+ */
+bool DirectoryIndex::locate(const std::string& name)
+{
+	/* check the last position and its neighbours, as used by previous and next */
+	for (const size_t index : {m_position, m_position + 1, m_position - 1})
+	{
+		if ((index < m_files.size()) && (m_files[index] == name))
+		{
+			m_position = index;
+			return true;
+		}
+	}
+
+	std::vector<std::string>::const_iterator iter = std::lower_bound(m_files.begin(), m_files.end(), name);
+
+	if ((iter == m_files.end()) || (*iter != name))
+	{
+		return false;
+	}
+	m_position = static_cast<size_t>(iter - m_files.begin());
+	return true;
+}
+
+/** get the neighbour of a file in its directory.
+ * @param file_name absolute path of the current file.
+ * @param step number of files to move, negative to move backwards.
+ * @return path of the neighbour, or the given file if there is no neighbour.
+ */
+std::string DirectoryIndex::step(const std::string& file_name, const int32_t step)
+{
+	FileSystem fs;
+	std::vector<std::string> path = fs.split_path(file_name);
+	const std::string directory = fs.join_path(path.begin(), path.end() - 1);
+	const std::string name = path[path.size() - 1];
+
+	process_events();
+
+	if (!m_valid || (directory != m_directory))
+	{
+		load(directory);
+	}
+
+	if (!locate(name))
+	{
+		return file_name;
+	}
+
+	if ((step < 0) && (static_cast<size_t>(-static_cast<int64_t>(step)) > m_position))
+	{
+		return file_name;
+	}
+
+	if ((step > 0) && (m_position + static_cast<size_t>(step) >= m_files.size()))
+	{
+		return file_name;
+	}
+
+	path[path.size() - 1] = m_files[static_cast<size_t>(static_cast<int64_t>(m_position) + step)];
+	return fs.join_path(path.begin(), path.end());
+}
@@ -0,0 +1,39 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef DIRECTORY_INDEX_H
+#define DIRECTORY_INDEX_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class DirectoryIndex
+{
+	private:
+		std::string m_directory;
+		std::vector<std::string> m_files;
+		size_t m_position;
+		int m_inotify_fd;
+		int m_watch;
+		bool m_valid;
+
+		DirectoryIndex(const DirectoryIndex&);
+		DirectoryIndex& operator=(const DirectoryIndex&);
+
+		void load(const std::string& directory);
+		void unwatch(void);
+		void process_events(void);
+		void insert(const std::string& name);
+		void remove(const std::string& name);
+		bool locate(const std::string& name);
+
+	public:
+		explicit DirectoryIndex(void);
+		~DirectoryIndex(void);
+
+		std::string step(const std::string& file_name, const int32_t step);
+};
+
+#endif
@@ -3,14 +3,17 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "file_system.h"
+#include "zip_archive.h"
 
 #include <unistd.h>
 #include <dirent.h>
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <stdexcept>
 #include <linux/limits.h>
 #include <algorithm>
 #include <fstream>
+#include <string.h>
 
 static const std::string directory_separator = "/";
 
@@ -62,6 +65,44 @@ bool FileSystem::is_video(const std::string& ext) const
 	return video_extensions.find(ext) != video_extensions.end();
 }
 
+bool FileSystem::is_archive(const std::string& ext) const
+{
+	static const std::set<std::string> archive_extensions = {
+		"zip",
+		"cbz"
+	};
+
+	return archive_extensions.find(ext) != archive_extensions.end();
+}
+
+/** split a path into an archive file and a member inside that archive.
+ * Archives are treated as directories, e.g. "/data/pano.zip/day1/img.jpg".
+ * @param path path to check.
+ * @param archive path of the archive file, if found.
+ * @param member path inside the archive, empty for the archive itself.
+ * @return flag, whether the path points into an archive.
+ */
+bool FileSystem::split_archive_path(const std::string& path, std::string& archive, std::string& member) const
+{
+	size_t end = 0;
+
+	while (end != std::string::npos)
+	{
+		end = path.find(directory_separator, end + 1);
+
+		const std::string candidate = path.substr(0, end);
+		struct stat sb;
+
+		if (is_archive(extension(candidate)) && !stat(candidate.c_str(), &sb) && S_ISREG(sb.st_mode))
+		{
+			archive = candidate;
+			member = (end == std::string::npos) ? "" : path.substr(end + directory_separator.size());
+			return true;
+		}
+	}
+	return false;
+}
+
 std::vector<std::string> FileSystem::split_path(const std::string& path) const
 {
 	std::vector<std::string> parts;
@@ -103,44 +144,165 @@ bool FileSystem::is_file(const std::string& name) const
 {
 	struct stat sb;
 
-	return !stat(name.c_str(), &sb) && S_ISREG(sb.st_mode);
+	if (!stat(name.c_str(), &sb))
+	{
+		return S_ISREG(sb.st_mode);
+	}
+
+	std::string archive;
+	std::string member;
+
+	return split_archive_path(name, archive, member) && ZipArchive::open(archive)->is_file(member);
 }
 
 bool FileSystem::is_directory(const std::string& name) const
 {
 	struct stat sb;
 
-	return !stat(name.c_str(), &sb) && S_ISDIR(sb.st_mode);
+	if (!stat(name.c_str(), &sb) && S_ISDIR(sb.st_mode))
+	{
+		return true;
+	}
+
+	std::string archive;
+	std::string member;
+
+	return split_archive_path(name, archive, member) && ZipArchive::open(archive)->is_directory(member);
 }
 
 std::set<std::string> FileSystem::select_files(const std::string& dir, const bool use_files, const bool use_dirs, const bool show_hidden) const
 {
+	const std::vector<directory_entry_t> scan = scan_directory(dir, false, show_hidden);
 	std::set<std::string> entries;
-	DIR* direct = opendir(dir.c_str());
 
-	if (direct == NULL)
+	for (std::vector<directory_entry_t>::const_iterator iter = scan.begin(); iter != scan.end(); ++iter)
 	{
-		throw std::runtime_error("could not open directory " + dir);
+		if (iter->is_directory ? use_dirs : use_files)
+		{
+			entries.insert(entries.end(), iter->name);
+		}
 	}
+	return entries;
+}
+
+/** list the media files and sub directories of a directory in a single pass.
+ * The entry type is taken from the directory itself, so plain entries need no stat() call.
+ * Only entries of unknown type and symbolic links are resolved with fstatat() relative
+ * to the opened directory, avoiding the path lookup for every entry.
+ * Archives are listed as directories.
+ * @param dir directory to scan, may be located inside an archive.
+ * @param with_details flag to query size and modification time of every listed entry.
+ * @param show_hidden flag to include names starting with a dot.
+ * @return entries sorted by name.
+ */
+std::vector<FileSystem::directory_entry_t> FileSystem::scan_directory(const std::string& dir, const bool with_details, const bool show_hidden) const
+{
+	std::vector<directory_entry_t> entries;
+	std::string archive;
+	std::string member;
+
+	if (split_archive_path(dir, archive, member))
+	{
+		std::shared_ptr<const ZipArchive> zip = ZipArchive::open(archive);
+		const std::set<std::string> files = zip->names(member, true, false);
+		const std::set<std::string> dirs = zip->names(member, false, true);
+		const std::string prefix = member.empty() ? "" : (member + directory_separator);
+
+		for (std::set<std::string>::const_iterator iter = dirs.begin(); iter != dirs.end(); ++iter)
+		{
+			if (show_hidden || ((*iter)[0] != '.'))
+			{
+				const directory_entry_t entry = {*iter, true, 0, 0};
+				entries.push_back(entry);
+			}
+		}
+
+		for (std::set<std::string>::const_iterator iter = files.begin(); iter != files.end(); ++iter)
+		{
+			const std::string ext = extension(*iter);
 
-	/* loop over all the files and directories within directory */
-	for (struct dirent* ent = readdir(direct); ent; ent = readdir(direct))
+			if ((show_hidden || ((*iter)[0] != '.')) && (is_image(ext) || is_video(ext)))
+			{
+				const directory_entry_t entry = {*iter, false, with_details ? zip->size(prefix + *iter) : 0, 0};
+				entries.push_back(entry);
+			}
+		}
+	}
+	else
 	{
-		const std::string en = ent->d_name;
-		const std::string name = dir + directory_separator + en;
-		const std::string ext = extension(en);
-
-		if ((en != ".") &&
-		    (en != "..") &&
-		    (!en.empty()) &&
-		    (show_hidden || (!show_hidden && (en[0] != '.'))) &&
-		    ((use_files && is_file(name) && (is_image(ext) || is_video(ext))) ||
-		     (use_dirs && is_directory(name))))
+		const int dir_fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+		if (dir_fd < 0)
+		{
+			throw std::runtime_error("could not open directory " + dir);
+		}
+
+		DIR* direct = fdopendir(dir_fd);
+
+		if (direct == NULL)
+		{
+			close(dir_fd);
+			throw std::runtime_error("could not open directory " + dir);
+		}
+
+		/* loop over all the files and directories within directory */
+		for (struct dirent* ent = readdir(direct); ent; ent = readdir(direct))
 		{
-			entries.insert(en);
+			const char* en = ent->d_name;
+
+			if ((en[0] == '\0') ||
+			    (!strcmp(en, ".")) ||
+			    (!strcmp(en, "..")) ||
+			    (!show_hidden && (en[0] == '.')))
+			{
+				continue;
+			}
+
+			unsigned char type = ent->d_type;
+			struct stat sb;
+			bool has_stat = false;
+
+			if ((type == DT_UNKNOWN) || (type == DT_LNK))
+			{
+				/* file system does not report types, or the target of a link is needed */
+				if (fstatat(dir_fd, en, &sb, 0))
+				{
+					continue;
+				}
+				has_stat = true;
+				type = S_ISDIR(sb.st_mode) ? DT_DIR : (S_ISREG(sb.st_mode) ? DT_REG : DT_UNKNOWN);
+			}
+
+			directory_entry_t entry = {en, false, 0, 0};
+			const std::string ext = extension(entry.name);
+
+			if ((type == DT_DIR) || ((type == DT_REG) && is_archive(ext)))
+			{
+				entry.is_directory = true;
+			}
+			else if ((type != DT_REG) || !(is_image(ext) || is_video(ext)))
+			{
+				continue;
+			}
+
+			if (with_details && !has_stat)
+			{
+				has_stat = !fstatat(dir_fd, en, &sb, 0);
+			}
+
+			if (has_stat)
+			{
+				entry.size = static_cast<uint64_t>(sb.st_size);
+				entry.mtime = sb.st_mtim.tv_sec;
+			}
+			entries.push_back(entry);
 		}
+		closedir(direct);
 	}
-	closedir(direct);
+
+	std::sort(entries.begin(), entries.end(), [](const directory_entry_t& a, const directory_entry_t& b){
+		return a.name < b.name;
+	});
 	return entries;
 }
 
@@ -5,12 +5,23 @@
 #ifndef FILE_SYSTEM_H
 #define FILE_SYSTEM_H
 
+#include <stdint.h>
 #include <string>
 #include <vector>
 #include <set>
 
 class FileSystem
 {
+	public:
+		typedef struct
+		{
+			std::string name;
+			bool is_directory;
+			uint64_t size;
+			int64_t mtime;
+		}
+		directory_entry_t;
+
 	private:
 		std::set<std::string> select_files(const std::string& dir, const bool use_files, const bool use_dirs, const bool show_hidden) const;
 
@@ -21,11 +32,14 @@ class FileSystem
 		std::string join_path(const std::vector<std::string>::const_iterator start, const std::vector<std::string>::const_iterator end) const;
 		std::set<std::string> file_names(const std::string& dir, const bool show_hidden = false) const;
 		std::set<std::string> directory_names(const std::string& dir, const bool show_hidden = false) const;
+		std::vector<directory_entry_t> scan_directory(const std::string& dir, const bool with_details, const bool show_hidden = false) const;
 		std::string extension(const std::string& name) const;
 		bool is_file(const std::string& name) const;
 		bool is_directory(const std::string& name) const;
 		bool is_image(const std::string& ext) const;
 		bool is_video(const std::string& ext) const;
+		bool is_archive(const std::string& ext) const;
+		bool split_archive_path(const std::string& path, std::string& archive, std::string& member) const;
 		std::string read_file(const std::string& path) const;
 };
 
@@ -4,13 +4,46 @@
 
 #include "image_data.h"
 #include "file_system.h"
+#include "zip_archive.h"
 #include <fstream>
+#include <streambuf>
 #include <string.h>
 #include <algorithm>
 #include <png.h>
 #include <jpeglib.h>
 #include <math.h>
 
+/** read-only stream buffer over image data in memory, avoiding a copy into a string stream.
+ */
+class MemoryBuffer : public std::streambuf
+{
+	public:
+		MemoryBuffer(const uint8_t* data, const size_t size) :
+			std::streambuf()
+		{
+			char* begin = const_cast<char*>(reinterpret_cast<const char*>(data));
+			setg(begin, begin, begin + size);
+		}
+
+	protected:
+		pos_type seekoff(off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode which) override
+		{
+			char* origin = (dir == std::ios_base::beg) ? eback() : ((dir == std::ios_base::end) ? egptr() : gptr());
+
+			if (!(which & std::ios_base::in) || (offset < eback() - origin) || (offset > egptr() - origin))
+			{
+				return pos_type(off_type(-1));
+			}
+			setg(eback(), origin + offset, egptr());
+			return pos_type(gptr() - eback());
+		}
+
+		pos_type seekpos(pos_type pos, std::ios_base::openmode which) override
+		{
+			return seekoff(off_type(pos), std::ios_base::beg, which);
+		}
+};
+
 ImageFile::ImageFile(const std::string& file_name) :
 	m_width(0),
 	m_height(0),
@@ -29,22 +62,76 @@ ImageFile::ImageFile(const std::string& file_name) :
 	}
 
 	const std::string ext = fs.extension(file_name);
+	std::string archive;
+	std::string member;
+
+	if (fs.split_archive_path(file_name, archive, member))
+	{
+		/* decode archive members from memory, only the member itself is read from the archive */
+		const std::vector<uint8_t> data = ZipArchive::open(archive)->read(member);
+		decode(ext, data);
+		return;
+	}
+
+	std::ifstream stream(file_name, std::ios::in | std::ios::binary);
+
+	if (!stream.good())
+	{
+		throw std::runtime_error("could not open file " + file_name);
+	}
+	decode(ext, stream);
+}
+
+/** decode an image, which has already been read into memory.
+ * @param file_name name of the file, used to determine the image format.
+ * @param data content of the file.
+ */
+ImageFile::ImageFile(const std::string& file_name, const std::vector<uint8_t>& data) :
+	m_width(0),
+	m_height(0),
+	m_bits_per_pixel(0),
+	m_pixels()
+{
+	FileSystem fs;
 
+	decode(fs.extension(file_name), data);
+}
+
+/** decode an image in memory without copying it.
+ * @param ext file extension, determining the image format.
+ * @param data content of the file.
+ */
+void ImageFile::decode(const std::string& ext, const std::vector<uint8_t>& data)
+{
+	if ((ext == "jpg") || (ext == "jpeg"))
+	{
+		load_jpg(data);
+		return;
+	}
+
+	MemoryBuffer buffer(data.data(), data.size());
+	std::istream stream(&buffer);
+
+	decode(ext, stream);
+}
+
+void ImageFile::decode(const std::string& ext, std::istream& stream)
+{
 	if (ext == "bmp")
 	{
-		load_bmp(file_name);
+		load_bmp(stream);
 	}
 	else if (ext == "tga")
 	{
-		load_tga(file_name);
+		load_tga(stream);
 	}
 	else if (ext == "png")
 	{
-		load_png(file_name);
+		load_png(stream);
 	}
 	else if ((ext == "jpg") || (ext == "jpeg"))
 	{
-		load_jpg(file_name);
+		load_jpg(std::vector<uint8_t>((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>()));
 	}
 	else
 	{
@@ -72,15 +159,8 @@ size_t ImageFile::bpp(void) const
 	return m_bits_per_pixel;
 }
 
-void ImageFile::load_bmp(const std::string& file_name)
+void ImageFile::load_bmp(std::istream& hFile)
 {
-	std::fstream hFile(file_name, std::ios::in | std::ios::binary);
-
-	if (!hFile.is_open())
-	{
-		throw std::invalid_argument("Error: File Not Found.");
-	}
-
 	hFile.seekg(0, std::ios::end);
 	size_t Length = static_cast<size_t>(hFile.tellg());
 	hFile.seekg(0, std::ios::beg);
@@ -89,13 +169,11 @@ void ImageFile::load_bmp(const std::string& file_name)
 
 	if ((FileInfo[0] != 'B') && (FileInfo[1] != 'M'))
 	{
-		hFile.close();
 		throw std::invalid_argument("Error: Invalid File Format. Bitmap Required.");
 	}
 
 	if ((FileInfo[28] != 24) && (FileInfo[28] != 32))
 	{
-		hFile.close();
 		throw std::invalid_argument("Error: Invalid File Format. 24 or 32 bit Image Required.");
 	}
 
@@ -108,10 +186,9 @@ void ImageFile::load_bmp(const std::string& file_name)
 
 	hFile.seekg(PixelsOffset, std::ios::beg);
 	hFile.read(reinterpret_cast<char*>(m_pixels.data()), size);
-	hFile.close();
 }
 
-void ImageFile::load_tga(const std::string& file_name)
+void ImageFile::load_tga(std::istream& hFile)
 {
 	typedef union
 	{
@@ -128,13 +205,6 @@ void ImageFile::load_tga(const std::string& file_name)
 	}
 	pixel_t;
 
-	std::fstream hFile(file_name, std::ios::in | std::ios::binary);
-
-	if (!hFile.is_open())
-	{
-		throw std::invalid_argument("File Not Found.");
-	}
-
 	uint8_t Header[18] = {0};
 	static uint8_t DeCompressed[12] = {0x0, 0x0, 0x2, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0};
 	static uint8_t IsCompressed[12] = {0x0, 0x0, 0xA, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0};
@@ -148,7 +218,6 @@ void ImageFile::load_tga(const std::string& file_name)
 
 	if ((m_bits_per_pixel != 24) && (m_bits_per_pixel != 32))
 	{
-		hFile.close();
 		throw std::invalid_argument("Invalid File Format. Required: 24 or 32 Bit Image.");
 	}
 
@@ -222,17 +291,24 @@ void ImageFile::load_tga(const std::string& file_name)
 	}
 	else
 	{
-		hFile.close();
 		throw std::invalid_argument("Invalid File Format. Required: 24 or 32 Bit TGA File.");
 	}
-
-	hFile.close();
 }
 
-void ImageFile::load_png(const std::string& file_name)
+static void png_read_stream(png_structp png, png_bytep data, png_size_t length)
 {
-	FILE* fp = fopen(file_name.c_str(), "rb");
+	std::istream* stream = static_cast<std::istream*>(png_get_io_ptr(png));
+
+	stream->read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(length));
 
+	if (static_cast<png_size_t>(stream->gcount()) != length)
+	{
+		png_error(png, "unexpected end of image data");
+	}
+}
+
+void ImageFile::load_png(std::istream& stream)
+{
 	png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
 
 	if (!png)
@@ -252,7 +328,7 @@ void ImageFile::load_png(const std::string& file_name)
 		abort();
 	}
 
-	png_init_io(png, fp);
+	png_set_read_fn(png, &stream, png_read_stream);
 	png_read_info(png, info);
 	m_width = png_get_image_width(png, info);
 	m_height = png_get_image_height(png, info);
@@ -316,14 +392,12 @@ void ImageFile::load_png(const std::string& file_name)
 	channels = png_get_channels(png, info);
 	m_bits_per_pixel = static_cast<uint16_t>(bit_depth * channels);
 
-	fclose(fp);
+	png_destroy_read_struct(&png, &info, nullptr);
 }
 
-void ImageFile::load_jpg(const std::string& file_name)
+void ImageFile::load_jpg(const std::vector<uint8_t>& data)
 {
-	FILE* file = fopen(file_name.c_str(), "rb");
-
-	if (file == nullptr)
+	if (data.empty())
 	{
 		return;
 	}
@@ -334,7 +408,7 @@ void ImageFile::load_jpg(const std::string& file_name)
 	info.err = jpeg_std_error(&err);
 	jpeg_create_decompress(&info);        // fills info structure
 
-	jpeg_stdio_src(&info, file);
+	jpeg_mem_src(&info, data.data(), data.size());
 	jpeg_read_header(&info, true);
 
 	jpeg_start_decompress(&info);
@@ -359,6 +433,4 @@ void ImageFile::load_jpg(const std::string& file_name)
 
 	jpeg_finish_decompress(&info);
 	jpeg_destroy_decompress(&info);
-
-	fclose(file);
 }
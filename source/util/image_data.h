@@ -8,6 +8,7 @@
 #include <stdint.h>
 #include <string>
 #include <vector>
+#include <istream>
 
 class ImageFile
 {
@@ -18,13 +19,16 @@ class ImageFile
 		std::vector<uint8_t> m_pixels;
 
 		std::string file_extension(const std::string& file_name) const;
-		void load_bmp(const std::string& file_name);
-		void load_tga(const std::string& file_name);
-		void load_png(const std::string& file_name);
-		void load_jpg(const std::string& file_name);
+		void load_bmp(std::istream& stream);
+		void load_tga(std::istream& stream);
+		void load_png(std::istream& stream);
+		void load_jpg(const std::vector<uint8_t>& data);
+		void decode(const std::string& ext, std::istream& stream);
+		void decode(const std::string& ext, const std::vector<uint8_t>& data);
 
 	public:
 		explicit ImageFile(const std::string& file_name);
+		ImageFile(const std::string& file_name, const std::vector<uint8_t>& data);
 
 		const std::vector<uint8_t>& pixels(void) const;
 		uint32_t width(void) const;
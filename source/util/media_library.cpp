@@ -0,0 +1,1164 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "media_library.h"
+#include "file_system.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdlib.h>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <set>
+
+/* The index file consists of a header, the file records grouped by directory,
+ * the directory records sorted by path, two permutations of the file records
+ * sorted by name and by modification time, and a pool of NUL terminated paths.
+ * All sections are aligned to 8 bytes, so the file can be used directly from a
+ * read-only memory mapping without loading it into memory.
+ */
+static const char index_magic[8] = {'C', 'V', 'R', 'L', 'I', 'B', 'R', 'Y'};
+static const uint32_t index_version = 1;
+
+typedef struct
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t record_size;
+	uint64_t record_count;
+	uint64_t directory_count;
+	uint64_t records_offset;
+	uint64_t directories_offset;
+	uint64_t by_name_offset;
+	uint64_t by_mtime_offset;
+	uint64_t strings_offset;
+	uint64_t strings_size;
+}
+header_t;
+
+typedef struct
+{
+	uint64_t size;
+	int64_t mtime;
+	uint64_t path;          // offset of the full path in the string pool
+	uint32_t width;
+	uint32_t height;
+	uint32_t duration;      // milliseconds
+	uint16_t name;          // offset of the file name within the path
+	uint8_t kind;
+	uint8_t projection;
+	uint8_t stereo;
+	uint8_t reserved[7];
+}
+record_t;
+
+typedef struct
+{
+	uint64_t path;
+	int64_t mtime;          // nanoseconds, changes when entries are added, removed or renamed
+	uint64_t first_record;
+	uint64_t record_count;
+}
+directory_t;
+
+static uint64_t align8(const uint64_t value)
+{
+	return (value + 7) & ~static_cast<uint64_t>(7);
+}
+
+template<typename T>
+static const T* section(const uint8_t* data, const uint64_t offset)
+{
+	return static_cast<const T*>(static_cast<const void*>(data + offset));
+}
+
+/** check that a section of the index file lies within the file.
+ * @param offset start of the section in bytes, aligned to 8 bytes.
+ * @param count number of elements.
+ * @param size size of an element in bytes.
+ * @param file_size size of the index file in bytes.
+ * @return flag, whether the section is valid.
+ */
+static bool section_valid(const uint64_t offset, const uint64_t count, const uint64_t size, const uint64_t file_size)
+{
+	return (offset <= file_size) && ((offset % 8) == 0) && (count <= (file_size - offset) / size);
+}
+
+static std::string join(const std::string& dir, const std::string& name)
+{
+	return ((!dir.empty()) && (dir[dir.size() - 1] == '/')) ? (dir + name) : (dir + "/" + name);
+}
+
+/** read-only view of an index file */
+class MediaIndex
+{
+	private:
+		void* m_data;
+		size_t m_size;
+		const header_t* m_header;
+		const record_t* m_records;
+		const directory_t* m_directories;
+		const uint32_t* m_by_name;
+		const uint32_t* m_by_mtime;
+		const char* m_strings;
+
+		MediaIndex(const MediaIndex&);
+		MediaIndex& operator=(const MediaIndex&);
+
+	public:
+		explicit MediaIndex(const std::string& file_name);
+		~MediaIndex(void);
+
+		uint64_t record_count(void) const;
+		const record_t& record(const uint64_t index) const;
+		const record_t& record(const MediaLibrary::sort_t order, const uint64_t index) const;
+		const char* path(const record_t& record) const;
+		const char* name(const record_t& record) const;
+		const directory_t* lower_directory(const std::string& path) const;
+		const directory_t* find_directory(const std::string& path) const;
+		const record_t* find_record(const directory_t& dir, const std::string& path) const;
+		std::vector<std::string> subdirectories(const std::string& path) const;
+		MediaLibrary::media_info_t info(const record_t& record) const;
+};
+
+MediaIndex::MediaIndex(const std::string& file_name) :
+	m_data(MAP_FAILED),
+	m_size(0),
+	m_header(nullptr),
+	m_records(nullptr),
+	m_directories(nullptr),
+	m_by_name(nullptr),
+	m_by_mtime(nullptr),
+	m_strings(nullptr)
+{
+	const int fd = open(file_name.c_str(), O_RDONLY | O_CLOEXEC);
+
+	if (fd < 0)
+	{
+		throw std::runtime_error("could not open media index " + file_name);
+	}
+
+	struct stat sb;
+
+	if (fstat(fd, &sb) || (static_cast<uint64_t>(sb.st_size) < sizeof(header_t)))
+	{
+		close(fd);
+		throw std::runtime_error("invalid media index " + file_name);
+	}
+
+	m_size = static_cast<size_t>(sb.st_size);
+	m_data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (m_data == MAP_FAILED)
+	{
+		throw std::runtime_error("could not map media index " + file_name);
+	}
+
+	const uint8_t* data = static_cast<const uint8_t*>(m_data);
+
+	m_header = section<header_t>(data, 0);
+
+	const header_t& h = *m_header;
+	const bool valid = (!memcmp(h.magic, index_magic, sizeof(index_magic))) &&
+	                   (h.version == index_version) &&
+	                   (h.record_size == sizeof(record_t)) &&
+	                   section_valid(h.records_offset, h.record_count, sizeof(record_t), m_size) &&
+	                   section_valid(h.directories_offset, h.directory_count, sizeof(directory_t), m_size) &&
+	                   section_valid(h.by_name_offset, h.record_count, sizeof(uint32_t), m_size) &&
+	                   section_valid(h.by_mtime_offset, h.record_count, sizeof(uint32_t), m_size) &&
+	                   section_valid(h.strings_offset, h.strings_size, 1, m_size) &&
+	                   (h.strings_size > 0) &&
+	                   (data[h.strings_offset + h.strings_size - 1] == '\0');
+
+	if (!valid)
+	{
+		munmap(m_data, m_size);
+		throw std::runtime_error("invalid media index " + file_name);
+	}
+
+	m_records = section<record_t>(data, h.records_offset);
+	m_directories = section<directory_t>(data, h.directories_offset);
+	m_by_name = section<uint32_t>(data, h.by_name_offset);
+	m_by_mtime = section<uint32_t>(data, h.by_mtime_offset);
+	m_strings = section<char>(data, h.strings_offset);
+
+	/* entries are looked up in random order by the views */
+	madvise(m_data, m_size, MADV_RANDOM);
+}
+
+MediaIndex::~MediaIndex(void)
+{
+	munmap(m_data, m_size);
+}
+
+uint64_t MediaIndex::record_count(void) const
+{
+	return m_header->record_count;
+}
+
+const record_t& MediaIndex::record(const uint64_t index) const
+{
+	return m_records[index];
+}
+
+const record_t& MediaIndex::record(const MediaLibrary::sort_t order, const uint64_t index) const
+{
+	const uint32_t* view = (order == MediaLibrary::SORT_MTIME) ? m_by_mtime : m_by_name;
+
+	return m_records[std::min<uint64_t>(view[index], m_header->record_count - 1)];
+}
+
+const char* MediaIndex::path(const record_t& r) const
+{
+	return (r.path < m_header->strings_size) ? (m_strings + r.path) : "";
+}
+
+const char* MediaIndex::name(const record_t& r) const
+{
+	const char* p = path(r);
+
+	return (r.name <= strlen(p)) ? (p + r.name) : p;
+}
+
+/** find the first directory, which is not ordered before a path.
+ * @param dir_path absolute path.
+ * @return directory record, the end of the directories if there is none.
+ */
+const directory_t* MediaIndex::lower_directory(const std::string& dir_path) const
+{
+	const directory_t* begin = m_directories;
+	const directory_t* end = m_directories + m_header->directory_count;
+
+	return std::lower_bound(begin, end, dir_path, [this](const directory_t& d, const std::string& p){
+		return strcmp(m_strings + std::min(d.path, m_header->strings_size - 1), p.c_str()) < 0;
+	});
+}
+
+/** find the records of a directory.
+ * @param dir_path absolute path of the directory.
+ * @return directory record, nullptr if the directory is not part of the index.
+ */
+const directory_t* MediaIndex::find_directory(const std::string& dir_path) const
+{
+	const directory_t* end = m_directories + m_header->directory_count;
+	const directory_t* iter = lower_directory(dir_path);
+
+	if ((iter == end) || (strcmp(m_strings + std::min(iter->path, m_header->strings_size - 1), dir_path.c_str()) != 0))
+	{
+		return nullptr;
+	}
+
+	if ((iter->first_record + iter->record_count) > m_header->record_count)
+	{
+		return nullptr;
+	}
+	return iter;
+}
+
+/** find the record of a file.
+ * The records of a directory are stored in the order of their names.
+ * @param dir directory record of the file.
+ * @param file_path absolute path of the file.
+ * @return file record, nullptr if the file is not part of the directory.
+ */
+const record_t* MediaIndex::find_record(const directory_t& dir, const std::string& file_path) const
+{
+	const record_t* begin = m_records + dir.first_record;
+	const record_t* end = begin + dir.record_count;
+	const record_t* iter = std::lower_bound(begin, end, file_path, [this](const record_t& r, const std::string& p){
+		return strcmp(path(r), p.c_str()) < 0;
+	});
+
+	if ((iter == end) || (file_path != path(*iter)))
+	{
+		return nullptr;
+	}
+	return iter;
+}
+
+/** list the indexed directories directly below a directory.
+ * The directories are sorted by path, so all directories below a directory follow it,
+ * and the ones further below a child are skipped with a single search.
+ * @param dir_path absolute path of the directory.
+ * @return absolute paths of the child directories.
+ */
+std::vector<std::string> MediaIndex::subdirectories(const std::string& dir_path) const
+{
+	const std::string prefix = join(dir_path, "");
+	const directory_t* end = m_directories + m_header->directory_count;
+	std::vector<std::string> result;
+
+	for (const directory_t* iter = lower_directory(prefix); iter != end;)
+	{
+		const char* p = m_strings + std::min(iter->path, m_header->strings_size - 1);
+
+		if (strncmp(p, prefix.c_str(), prefix.size()) != 0)
+		{
+			break;
+		}
+
+		const char* slash = strchr(p + prefix.size(), '/');
+
+		if (slash)
+		{
+			/* '0' directly follows '/', so this skips all paths starting with the child and a slash */
+			iter = lower_directory(std::string(p, static_cast<size_t>(slash - p)) + "0");
+		}
+		else
+		{
+			result.push_back(p);
+			++iter;
+		}
+	}
+	return result;
+}
+
+MediaLibrary::media_info_t MediaIndex::info(const record_t& r) const
+{
+	const MediaLibrary::media_info_t i = {
+		path(r),
+		r.size,
+		r.mtime,
+		r.width,
+		r.height,
+		r.duration,
+		static_cast<MediaLibrary::kind_t>(r.kind),
+		static_cast<MediaLibrary::projection_t>(r.projection),
+		static_cast<MediaLibrary::stereo_t>(r.stereo)
+	};
+
+	return i;
+}
+
+/** builder of a new index file.
+ * Records and paths are streamed to temporary files while crawling,
+ * so memory use does not grow with the number of files.
+ */
+class IndexWriter
+{
+	private:
+		std::string m_file_name;
+		std::string m_records_name;
+		std::string m_strings_name;
+		std::ofstream m_records;
+		std::ofstream m_strings;
+		uint64_t m_record_count;
+		uint64_t m_strings_size;
+		std::vector<std::pair<std::string, directory_t> > m_directories;
+
+		IndexWriter(const IndexWriter&);
+		IndexWriter& operator=(const IndexWriter&);
+
+		uint64_t add_string(const std::string& s);
+
+	public:
+		explicit IndexWriter(const std::string& file_name);
+		~IndexWriter(void);
+
+		uint64_t record_count(void) const;
+		void add_record(const std::string& path, record_t record);
+		void add_directory(const std::string& path, const int64_t mtime, const uint64_t first_record);
+		bool finish(void);
+};
+
+IndexWriter::IndexWriter(const std::string& file_name) :
+	m_file_name(file_name),
+	m_records_name(file_name + ".tmp"),
+	m_strings_name(file_name + ".strings.tmp"),
+	m_records(m_records_name, std::ios::out | std::ios::binary | std::ios::trunc),
+	m_strings(m_strings_name, std::ios::out | std::ios::binary | std::ios::trunc),
+	m_record_count(0),
+	m_strings_size(0),
+	m_directories()
+{
+	const header_t header = {};
+
+	/* the header is written last, when all offsets are known */
+	m_records.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+IndexWriter::~IndexWriter(void)
+{
+	m_records.close();
+	m_strings.close();
+	unlink(m_records_name.c_str());
+	unlink(m_strings_name.c_str());
+}
+
+uint64_t IndexWriter::record_count(void) const
+{
+	return m_record_count;
+}
+
+uint64_t IndexWriter::add_string(const std::string& s)
+{
+	const uint64_t offset = m_strings_size;
+
+	m_strings.write(s.c_str(), static_cast<std::streamsize>(s.size() + 1));
+	m_strings_size += s.size() + 1;
+	return offset;
+}
+
+void IndexWriter::add_record(const std::string& path, record_t record)
+{
+	record.path = add_string(path);
+	m_records.write(reinterpret_cast<const char*>(&record), sizeof(record));
+	m_record_count++;
+}
+
+/** close the records of a directory.
+ * All records added since the last call belong to this directory.
+ */
+void IndexWriter::add_directory(const std::string& path, const int64_t mtime, const uint64_t first_record)
+{
+	const directory_t dir = {add_string(path), mtime, first_record, m_record_count - first_record};
+
+	m_directories.push_back(std::make_pair(path, dir));
+}
+
+/** write the sorted views and the header, and replace the previous index.
+ * @return flag, whether the index was written successfully.
+ */
+bool IndexWriter::finish(void)
+{
+	if (m_strings_size == 0)
+	{
+		add_string("");
+	}
+	m_strings.close();
+
+	if (!m_records.good() || !m_strings.good() || (m_record_count > UINT32_MAX))
+	{
+		return false;
+	}
+
+	header_t header = {};
+
+	memcpy(header.magic, index_magic, sizeof(index_magic));
+	header.version = index_version;
+	header.record_size = sizeof(record_t);
+	header.record_count = m_record_count;
+	header.directory_count = m_directories.size();
+	header.records_offset = sizeof(header_t);
+	header.strings_size = m_strings_size;
+
+	uint64_t offset = header.records_offset + m_record_count * sizeof(record_t);
+	const std::vector<char> padding(8, 0);
+
+	std::sort(m_directories.begin(), m_directories.end(), [](const std::pair<std::string, directory_t>& a, const std::pair<std::string, directory_t>& b){
+		return a.first < b.first;
+	});
+
+	header.directories_offset = align8(offset);
+	m_records.write(padding.data(), static_cast<std::streamsize>(header.directories_offset - offset));
+
+	for (std::vector<std::pair<std::string, directory_t> >::const_iterator iter = m_directories.begin(); iter != m_directories.end(); ++iter)
+	{
+		m_records.write(reinterpret_cast<const char*>(&iter->second), sizeof(directory_t));
+	}
+	offset = header.directories_offset + m_directories.size() * sizeof(directory_t);
+	m_directories.clear();
+	m_records.flush();
+
+	/* sort the records through read-only mappings of the temporary files */
+	const int records_fd = open(m_records_name.c_str(), O_RDONLY | O_CLOEXEC);
+	const int strings_fd = open(m_strings_name.c_str(), O_RDONLY | O_CLOEXEC);
+	const size_t records_size = header.records_offset + m_record_count * sizeof(record_t);
+	void* records_map = (records_fd < 0) ? MAP_FAILED : mmap(nullptr, records_size, PROT_READ, MAP_SHARED, records_fd, 0);
+	void* strings_map = (strings_fd < 0) ? MAP_FAILED : mmap(nullptr, m_strings_size, PROT_READ, MAP_SHARED, strings_fd, 0);
+
+	if (records_fd >= 0)
+	{
+		close(records_fd);
+	}
+
+	if (strings_fd >= 0)
+	{
+		close(strings_fd);
+	}
+
+	if ((records_map == MAP_FAILED) || (strings_map == MAP_FAILED))
+	{
+		if (records_map != MAP_FAILED)
+		{
+			munmap(records_map, records_size);
+		}
+
+		if (strings_map != MAP_FAILED)
+		{
+			munmap(strings_map, m_strings_size);
+		}
+		return false;
+	}
+
+	const record_t* records = section<record_t>(static_cast<const uint8_t*>(records_map), header.records_offset);
+	const char* strings = static_cast<const char*>(strings_map);
+	std::vector<uint32_t> view(m_record_count);
+
+	std::iota(view.begin(), view.end(), 0);
+	std::sort(view.begin(), view.end(), [records, strings](const uint32_t a, const uint32_t b){
+		const int diff = strcasecmp(strings + records[a].path + records[a].name, strings + records[b].path + records[b].name);
+
+		return (diff != 0) ? (diff < 0) : (strcmp(strings + records[a].path, strings + records[b].path) < 0);
+	});
+
+	header.by_name_offset = align8(offset);
+	m_records.write(padding.data(), static_cast<std::streamsize>(header.by_name_offset - offset));
+	m_records.write(reinterpret_cast<const char*>(view.data()), static_cast<std::streamsize>(view.size() * sizeof(uint32_t)));
+	offset = header.by_name_offset + view.size() * sizeof(uint32_t);
+
+	/* newest first */
+	std::stable_sort(view.begin(), view.end(), [records](const uint32_t a, const uint32_t b){
+		return records[a].mtime > records[b].mtime;
+	});
+
+	header.by_mtime_offset = align8(offset);
+	m_records.write(padding.data(), static_cast<std::streamsize>(header.by_mtime_offset - offset));
+	m_records.write(reinterpret_cast<const char*>(view.data()), static_cast<std::streamsize>(view.size() * sizeof(uint32_t)));
+	offset = header.by_mtime_offset + view.size() * sizeof(uint32_t);
+
+	header.strings_offset = align8(offset);
+	m_records.write(padding.data(), static_cast<std::streamsize>(header.strings_offset - offset));
+	m_records.write(strings, static_cast<std::streamsize>(m_strings_size));
+
+	munmap(records_map, records_size);
+	munmap(strings_map, m_strings_size);
+
+	m_records.seekp(0);
+	m_records.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	m_records.close();
+
+	if (m_records.fail())
+	{
+		return false;
+	}
+
+	/* readers of the previous index keep their mapping of the replaced file */
+	return !rename(m_records_name.c_str(), m_file_name.c_str());
+}
+
+static uint16_t read_be16(const uint8_t* p)
+{
+	return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+static uint32_t read_be32(const uint8_t* p)
+{
+	return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) | (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+static uint64_t read_be64(const uint8_t* p)
+{
+	return (static_cast<uint64_t>(read_be32(p)) << 32) | read_be32(p + 4);
+}
+
+static uint32_t read_le32(const uint8_t* p)
+{
+	return (static_cast<uint32_t>(p[3]) << 24) | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[1]) << 8) | p[0];
+}
+
+static bool read_bytes(std::istream& stream, uint8_t* buffer, const size_t size)
+{
+	stream.read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(size));
+	return stream.good();
+}
+
+/** determine the dimensions of an image from its header, without decoding it. */
+static void probe_image(std::istream& stream, const std::string& ext, record_t& record)
+{
+	uint8_t h[32];
+
+	if (!read_bytes(stream, h, 26))
+	{
+		return;
+	}
+
+	if (ext == "png")
+	{
+		/* IHDR is always the first chunk */
+		record.width = read_be32(h + 16);
+		record.height = read_be32(h + 20);
+	}
+	else if (ext == "bmp")
+	{
+		record.width = read_le32(h + 18);
+		record.height = static_cast<uint32_t>(abs(static_cast<int32_t>(read_le32(h + 22))));
+	}
+	else if (ext == "tga")
+	{
+		record.width = static_cast<uint32_t>(h[12] | (h[13] << 8));
+		record.height = static_cast<uint32_t>(h[14] | (h[15] << 8));
+	}
+	else if (((ext == "jpg") || (ext == "jpeg")) && (h[0] == 0xff) && (h[1] == 0xd8))
+	{
+		/* walk the segments up to the start of frame */
+		stream.seekg(2);
+
+		for (size_t i = 0; (i < 1024) && read_bytes(stream, h, 4); i++)
+		{
+			const uint8_t marker = h[1];
+			const uint16_t length = read_be16(h + 2);
+
+			if ((h[0] != 0xff) || (length < 2))
+			{
+				break;
+			}
+
+			if ((marker >= 0xc0) && (marker <= 0xcf) && (marker != 0xc4) && (marker != 0xc8) && (marker != 0xcc))
+			{
+				if (read_bytes(stream, h, 5))
+				{
+					record.height = read_be16(h + 1);
+					record.width = read_be16(h + 3);
+				}
+				break;
+			}
+			stream.seekg(length - 2, std::ios::cur);
+		}
+	}
+}
+
+/** determine duration and dimensions of an ISO media file (mp4) from its boxes. */
+static void probe_mp4(std::istream& stream, const uint64_t start, const uint64_t end, record_t& record, const size_t depth)
+{
+	uint64_t pos = start;
+
+	while ((depth < 4) && (pos + 8 <= end))
+	{
+		uint8_t h[32];
+
+		stream.seekg(static_cast<std::streamoff>(pos));
+
+		if (!read_bytes(stream, h, 8))
+		{
+			return;
+		}
+
+		const std::string type(reinterpret_cast<const char*>(h + 4), 4);
+		uint64_t size = read_be32(h);
+		uint64_t header = 8;
+
+		if (size == 1)
+		{
+			if (!read_bytes(stream, h, 8))
+			{
+				return;
+			}
+			size = read_be64(h);
+			header = 16;
+		}
+		else if (size == 0)
+		{
+			size = end - pos;
+		}
+
+		if ((size < header) || (pos + size > end))
+		{
+			return;
+		}
+
+		if ((type == "moov") || (type == "trak"))
+		{
+			probe_mp4(stream, pos + header, pos + size, record, depth + 1);
+		}
+		else if ((type == "mvhd") && read_bytes(stream, h, 32))
+		{
+			const bool v1 = (h[0] == 1);
+			const uint32_t timescale = v1 ? read_be32(h + 20) : read_be32(h + 12);
+			const uint64_t duration = v1 ? read_be64(h + 24) : read_be32(h + 16);
+
+			if (timescale > 0)
+			{
+				record.duration = static_cast<uint32_t>(std::min<uint64_t>(duration * 1000 / timescale, UINT32_MAX));
+			}
+		}
+		else if ((type == "tkhd") && (record.width == 0) && (size >= header + 84))
+		{
+			/* width and height are the last fields, as 16.16 fixed point numbers */
+			stream.seekg(static_cast<std::streamoff>(pos + size - 8));
+
+			if (read_bytes(stream, h, 8))
+			{
+				record.width = read_be32(h) >> 16;
+				record.height = read_be32(h + 4) >> 16;
+			}
+		}
+		pos += size;
+	}
+}
+
+/** guess projection and stereo layout from the usual file name tags and the aspect ratio. */
+static void guess_layout(const std::string& name, record_t& record)
+{
+	std::vector<std::string> tokens;
+	std::string token;
+
+	for (std::string::const_iterator iter = name.begin(); iter != name.end(); ++iter)
+	{
+		if (isalnum(static_cast<unsigned char>(*iter)))
+		{
+			token += static_cast<char>(tolower(static_cast<unsigned char>(*iter)));
+		}
+		else if (!token.empty())
+		{
+			tokens.push_back(token);
+			token.clear();
+		}
+	}
+	tokens.push_back(token);
+
+	MediaLibrary::projection_t projection = MediaLibrary::PROJECTION_UNKNOWN;
+	MediaLibrary::stereo_t stereo = MediaLibrary::STEREO_UNKNOWN;
+
+	for (std::vector<std::string>::const_iterator iter = tokens.begin(); iter != tokens.end(); ++iter)
+	{
+		const std::string& t = *iter;
+
+		if ((t == "360") || (t == "vr360") || (t == "360vr") || (t == "equirect") || (t == "erp"))
+		{
+			projection = MediaLibrary::PROJECTION_SPHERE_360;
+		}
+		else if ((t == "180") || (t == "vr180") || (t == "180vr") || (t == "180x180"))
+		{
+			projection = MediaLibrary::PROJECTION_SPHERE_180;
+		}
+		else if ((t == "fisheye") || (t == "fish190") || (t == "fish200") || (t == "mkx200"))
+		{
+			projection = MediaLibrary::PROJECTION_FISHEYE;
+		}
+		else if ((t == "cube") || (t == "cubemap") || (t == "eac"))
+		{
+			projection = MediaLibrary::PROJECTION_CUBE_MAP;
+		}
+		else if ((t == "flat") || (t == "2d"))
+		{
+			projection = MediaLibrary::PROJECTION_FLAT;
+		}
+
+		if ((t == "lr") || (t == "sbs") || (t == "3dh") || (t == "stereo"))
+		{
+			stereo = MediaLibrary::STEREO_LEFT_RIGHT;
+		}
+		else if ((t == "tb") || (t == "ou") || (t == "3dv") || (t == "overunder"))
+		{
+			stereo = MediaLibrary::STEREO_TOP_BOTTOM;
+		}
+		else if ((t == "mono") || (t == "2d"))
+		{
+			stereo = MediaLibrary::STEREO_MONO;
+		}
+	}
+
+	if ((record.width > 0) && (record.height > 0))
+	{
+		const float aspect = static_cast<float>(record.width) / static_cast<float>(record.height);
+		const bool square = (aspect > 0.9f) && (aspect < 1.1f);
+		const bool wide = (aspect > 1.9f) && (aspect < 2.1f);
+		const bool double_wide = (aspect > 3.8f) && (aspect < 4.2f);
+
+		if ((projection == MediaLibrary::PROJECTION_UNKNOWN) && (stereo == MediaLibrary::STEREO_UNKNOWN) && wide)
+		{
+			/* most common layout of untagged panoramas */
+			projection = MediaLibrary::PROJECTION_SPHERE_360;
+		}
+
+		if (stereo == MediaLibrary::STEREO_UNKNOWN)
+		{
+			if (projection == MediaLibrary::PROJECTION_SPHERE_360)
+			{
+				stereo = square ? MediaLibrary::STEREO_TOP_BOTTOM : (double_wide ? MediaLibrary::STEREO_LEFT_RIGHT : MediaLibrary::STEREO_MONO);
+			}
+			else if ((projection == MediaLibrary::PROJECTION_SPHERE_180) || (projection == MediaLibrary::PROJECTION_FISHEYE))
+			{
+				stereo = wide ? MediaLibrary::STEREO_LEFT_RIGHT : MediaLibrary::STEREO_MONO;
+			}
+		}
+
+		if ((projection == MediaLibrary::PROJECTION_UNKNOWN) && !square && !wide && !double_wide)
+		{
+			projection = MediaLibrary::PROJECTION_FLAT;
+		}
+	}
+	record.projection = static_cast<uint8_t>(projection);
+	record.stereo = static_cast<uint8_t>(stereo);
+}
+
+/** collect the metadata of a single media file. */
+static record_t probe_file(const std::string& path, const size_t name_offset, const struct stat& sb)
+{
+	FileSystem fs;
+	const std::string ext = fs.extension(path);
+	record_t record = {};
+
+	record.size = static_cast<uint64_t>(sb.st_size);
+	record.mtime = sb.st_mtim.tv_sec;
+	record.name = static_cast<uint16_t>(name_offset);
+	record.kind = static_cast<uint8_t>(fs.is_image(ext) ? MediaLibrary::KIND_IMAGE : MediaLibrary::KIND_VIDEO);
+
+	std::ifstream stream(path, std::ios::in | std::ios::binary);
+
+	if (stream.good())
+	{
+		if (fs.is_image(ext))
+		{
+			probe_image(stream, ext, record);
+		}
+		else if (ext == "mp4")
+		{
+			probe_mp4(stream, 0, record.size, record, 0);
+		}
+	}
+	guess_layout(path.substr(name_offset), record);
+	return record;
+}
+
+/** add a file to the new index.
+ * The previous record is reused, while the size and the modification time of the file are unchanged,
+ * e.g. a file rewritten in place is probed again.
+ * @param writer new index.
+ * @param path absolute path of the file.
+ * @param name_offset offset of the file name within the path.
+ * @param known record of the file in the previous index, nullptr if none.
+ */
+static void add_file(IndexWriter& writer, const std::string& path, const size_t name_offset, const record_t* known)
+{
+	struct stat sb;
+
+	if (stat(path.c_str(), &sb) || !S_ISREG(sb.st_mode))
+	{
+		return;
+	}
+
+	if (known && (known->size == static_cast<uint64_t>(sb.st_size)) && (known->mtime == sb.st_mtim.tv_sec))
+	{
+		writer.add_record(path, *known);
+	}
+	else
+	{
+		writer.add_record(path, probe_file(path, name_offset, sb));
+	}
+}
+
+static void crawl_directory(IndexWriter& writer, const MediaIndex* previous, const std::string& dir,
+                            std::set<std::pair<dev_t, ino_t> >& visited, const std::atomic<bool>& running)
+{
+	struct stat sb;
+
+	/* symbolic links may lead to directories, which have been visited already */
+	if (!running.load() || stat(dir.c_str(), &sb) || !visited.insert(std::make_pair(sb.st_dev, sb.st_ino)).second)
+	{
+		return;
+	}
+
+	const int64_t dir_mtime = sb.st_mtim.tv_sec * 1000000000 + sb.st_mtim.tv_nsec;
+	const directory_t* known = previous ? previous->find_directory(dir) : nullptr;
+	const uint64_t first_record = writer.record_count();
+	std::vector<std::string> subdirectories;
+
+	if (known && (known->mtime == dir_mtime))
+	{
+		/* no entry has been added, removed or renamed since the last crawl, so the directory is not listed again */
+		for (uint64_t i = known->first_record; i < known->first_record + known->record_count; i++)
+		{
+			const record_t& record = previous->record(i);
+
+			add_file(writer, previous->path(record), record.name, &record);
+		}
+		subdirectories = previous->subdirectories(dir);
+	}
+	else
+	{
+		FileSystem fs;
+		std::vector<FileSystem::directory_entry_t> entries;
+
+		try
+		{
+			entries = fs.scan_directory(dir, false);
+		}
+		catch (const std::runtime_error&)
+		{
+			return;
+		}
+
+		for (std::vector<FileSystem::directory_entry_t>::const_iterator iter = entries.begin(); iter != entries.end(); ++iter)
+		{
+			const std::string path = join(dir, iter->name);
+
+			if (!iter->is_directory)
+			{
+				add_file(writer, path, path.size() - iter->name.size(), known ? previous->find_record(*known, path) : nullptr);
+			}
+			else if (!fs.is_archive(fs.extension(iter->name)))
+			{
+				/* archives are listed as directories, but their content is not indexed */
+				subdirectories.push_back(path);
+			}
+		}
+	}
+	writer.add_directory(dir, dir_mtime, first_record);
+
+	for (std::vector<std::string>::const_iterator iter = subdirectories.begin(); iter != subdirectories.end(); ++iter)
+	{
+		crawl_directory(writer, previous, *iter, visited, running);
+	}
+}
+
+MediaLibrary::MediaLibrary(void) :
+	m_index_file(),
+	m_roots(),
+	m_index(),
+	m_thread(),
+	m_running(false),
+	m_scanning(false),
+	m_mutex()
+{
+}
+
+MediaLibrary::~MediaLibrary(void)
+{
+	stop();
+}
+
+/** location of the index in the user's cache directory. */
+std::string MediaLibrary::default_index_file(void)
+{
+	const char* cache = getenv("XDG_CACHE_HOME");
+	const char* home = getenv("HOME");
+
+	if (cache && cache[0])
+	{
+		return std::string(cache) + "/cine-vr/library.idx";
+	}
+	return std::string(home ? home : "/tmp") + "/.cache/cine-vr/library.idx";
+}
+
+/** open the existing index and start updating it in the background.
+ * The previous index is usable immediately. Only changed directories are listed again,
+ * and only new or changed files are probed again.
+ * @param roots directories to crawl recursively.
+ * @param index_file file storing the index between runs.
+ */
+void MediaLibrary::start(const std::vector<std::string>& roots, const std::string& index_file)
+{
+	stop();
+
+	m_roots = roots;
+	m_index_file = index_file;
+
+	try
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_index = std::make_shared<const MediaIndex>(m_index_file);
+	}
+	catch (const std::runtime_error& e)
+	{
+		std::cout << "creating new media index: " << e.what() << std::endl;
+	}
+
+	m_running.store(true);
+	m_scanning.store(true);
+	m_thread = std::thread(&MediaLibrary::crawl_thread, this);
+}
+
+void MediaLibrary::stop(void)
+{
+	m_running.store(false);
+
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+}
+
+/** check, whether the index has been opened by start().
+ * @return flag, whether the library has been started.
+ */
+bool MediaLibrary::started(void) const
+{
+	return !m_index_file.empty();
+}
+
+bool MediaLibrary::scanning(void) const
+{
+	return m_scanning.load();
+}
+
+std::shared_ptr<const MediaIndex> MediaLibrary::index(void) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	return m_index;
+}
+
+void MediaLibrary::crawl_thread(void)
+{
+	/* create the cache directory including its parents */
+	for (size_t pos = m_index_file.find('/', 1); pos != std::string::npos; pos = m_index_file.find('/', pos + 1))
+	{
+		mkdir(m_index_file.substr(0, pos).c_str(), 0755);
+	}
+
+	const std::shared_ptr<const MediaIndex> previous = index();
+	std::set<std::pair<dev_t, ino_t> > visited;
+	bool success = false;
+
+	{
+		IndexWriter writer(m_index_file);
+
+		for (std::vector<std::string>::const_iterator iter = m_roots.begin(); iter != m_roots.end(); ++iter)
+		{
+			crawl_directory(writer, previous.get(), *iter, visited, m_running);
+		}
+
+		/* an interrupted crawl would drop the files not visited yet */
+		success = m_running.load() && writer.finish();
+	}
+
+	if (success)
+	{
+		try
+		{
+			const std::shared_ptr<const MediaIndex> updated = std::make_shared<const MediaIndex>(m_index_file);
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_index = updated;
+		}
+		catch (const std::runtime_error& e)
+		{
+			std::cerr << e.what() << std::endl;
+		}
+	}
+	else if (m_running.load())
+	{
+		std::cerr << "could not write media index " << m_index_file << std::endl;
+	}
+	m_scanning.store(false);
+}
+
+size_t MediaLibrary::size(void) const
+{
+	const std::shared_ptr<const MediaIndex> idx = index();
+
+	return idx ? idx->record_count() : 0;
+}
+
+/** get a range of a sorted view of all media files.
+ * @param order sort by name, or newest first.
+ * @param first index of the first entry of the range.
+ * @param count maximum number of entries.
+ * @return entries of the range.
+ */
+std::vector<MediaLibrary::media_info_t> MediaLibrary::sorted(const sort_t order, const size_t first, const size_t count) const
+{
+	const std::shared_ptr<const MediaIndex> idx = index();
+	std::vector<media_info_t> result;
+
+	if (!idx)
+	{
+		return result;
+	}
+
+	for (uint64_t i = first; (i < idx->record_count()) && (result.size() < count); i++)
+	{
+		result.push_back(idx->info(idx->record(order, i)));
+	}
+	return result;
+}
+
+/** search media files by name.
+ * A prefix search uses the name ordered view and only visits the matches,
+ * a substring search compares the full paths of all files.
+ * @param text text to search for, ignoring case.
+ * @param prefix flag to match the start of the file names only.
+ * @param max_results maximum number of results.
+ * @return matches, ordered by name.
+ */
+std::vector<MediaLibrary::media_info_t> MediaLibrary::search(const std::string& text, const bool prefix, const size_t max_results) const
+{
+	const std::shared_ptr<const MediaIndex> idx = index();
+	std::vector<media_info_t> result;
+
+	if (!idx)
+	{
+		return result;
+	}
+
+	const uint64_t count = idx->record_count();
+
+	if (prefix)
+	{
+		uint64_t low = 0;
+		uint64_t high = count;
+
+		while (low < high)
+		{
+			const uint64_t mid = low + (high - low) / 2;
+
+			if (strncasecmp(idx->name(idx->record(SORT_NAME, mid)), text.c_str(), text.size()) < 0)
+			{
+				low = mid + 1;
+			}
+			else
+			{
+				high = mid;
+			}
+		}
+
+		for (uint64_t i = low; (i < count) && (result.size() < max_results); i++)
+		{
+			const record_t& record = idx->record(SORT_NAME, i);
+
+			if (strncasecmp(idx->name(record), text.c_str(), text.size()) != 0)
+			{
+				break;
+			}
+			result.push_back(idx->info(record));
+		}
+	}
+	else
+	{
+		for (uint64_t i = 0; (i < count) && (result.size() < max_results); i++)
+		{
+			const record_t& record = idx->record(SORT_NAME, i);
+
+			if (strcasestr(idx->path(record), text.c_str()))
+			{
+				result.push_back(idx->info(record));
+			}
+		}
+	}
+	return result;
+}
+
+/** get the metadata of a single file.
+ * @param file_name absolute path of the file.
+ * @param info metadata, if the file is part of the index.
+ * @return flag, whether the file is part of the index.
+ */
+bool MediaLibrary::lookup(const std::string& file_name, media_info_t& info) const
+{
+	const std::shared_ptr<const MediaIndex> idx = index();
+	const size_t slash = file_name.rfind('/');
+
+	if (!idx || (slash == std::string::npos))
+	{
+		return false;
+	}
+
+	const directory_t* dir = idx->find_directory(file_name.substr(0, std::max<size_t>(slash, 1)));
+	const record_t* record = dir ? idx->find_record(*dir, file_name) : nullptr;
+
+	if (!record)
+	{
+		return false;
+	}
+	info = idx->info(*record);
+	return true;
+}
@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef MEDIA_LIBRARY_H
+#define MEDIA_LIBRARY_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+class MediaIndex;
+
+class MediaLibrary
+{
+	public:
+		typedef enum
+		{
+			KIND_IMAGE,
+			KIND_VIDEO
+		}
+		kind_t;
+
+		typedef enum
+		{
+			PROJECTION_UNKNOWN,
+			PROJECTION_FLAT,
+			PROJECTION_SPHERE_180,
+			PROJECTION_SPHERE_360,
+			PROJECTION_FISHEYE,
+			PROJECTION_CUBE_MAP
+		}
+		projection_t;
+
+		typedef enum
+		{
+			STEREO_UNKNOWN,
+			STEREO_MONO,
+			STEREO_LEFT_RIGHT,
+			STEREO_TOP_BOTTOM
+		}
+		stereo_t;
+
+		typedef enum
+		{
+			SORT_NAME,
+			SORT_MTIME
+		}
+		sort_t;
+
+		typedef struct
+		{
+			std::string file_name;
+			uint64_t size;
+			int64_t mtime;
+			uint32_t width;
+			uint32_t height;
+			uint32_t duration;      // milliseconds, 0 if unknown
+			kind_t kind;
+			projection_t projection;
+			stereo_t stereo;
+		}
+		media_info_t;
+
+		explicit MediaLibrary(void);
+		~MediaLibrary(void);
+
+		static std::string default_index_file(void);
+
+		void start(const std::vector<std::string>& roots, const std::string& index_file);
+		void stop(void);
+		bool started(void) const;
+		bool scanning(void) const;
+
+		size_t size(void) const;
+		std::vector<media_info_t> sorted(const sort_t order, const size_t first, const size_t count) const;
+		std::vector<media_info_t> search(const std::string& text, const bool prefix, const size_t max_results) const;
+		bool lookup(const std::string& file_name, media_info_t& info) const;
+
+	private:
+		std::string m_index_file;
+		std::vector<std::string> m_roots;
+		std::shared_ptr<const MediaIndex> m_index;
+		std::thread m_thread;
+		std::atomic<bool> m_running;
+		std::atomic<bool> m_scanning;
+		mutable std::mutex m_mutex;
+
+		MediaLibrary(const MediaLibrary&);
+		MediaLibrary& operator=(const MediaLibrary&);
+
+		std::shared_ptr<const MediaIndex> index(void) const;
+		void crawl_thread(void);
+};
+
+#endif
@@ -238,6 +238,30 @@ void OpenVRInterface::handoff(void) const
 	m_compositor->PostPresentHandoff();
 }
 
+/** display timing for the frame about to be rendered.
+ * The delay covers the rest of the current vsync interval and the latency from vsync to photons.
+ * @return refresh rate, delay until display and vsync counter of the HMD.
+ */
+OpenVRInterface::frame_timing_t OpenVRInterface::frame_timing(void) const
+{
+	frame_timing_t timing = {0.0f, 0.0f, 0};
+	vr::ETrackedPropertyError error;
+	float since_vsync = 0.0f;
+
+	const float refresh_rate = m_system->GetFloatTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_DisplayFrequency_Float, &error);
+
+	if ((error != vr::TrackedProp_Success) || (refresh_rate <= 0.0f) || !m_system->GetTimeSinceLastVsync(&since_vsync, &timing.vsync))
+	{
+		return timing;
+	}
+
+	const float photons = m_system->GetFloatTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_SecondsFromVsyncToPhotons_Float, &error);
+
+	timing.refresh_rate = refresh_rate;
+	timing.display_delay = 1.0f / refresh_rate - since_vsync + ((error == vr::TrackedProp_Success) ? photons : 0.0f);
+	return timing;
+}
+
 void OpenVRInterface::update(void) const
 {
 	vr::VRActiveActionSet_t actionSet = { m_actionset, vr::k_ulInvalidInputValueHandle, 0, 0, 0 };
@@ -269,6 +293,30 @@ bool OpenVRInterface::getButtonAction(const input_action_t action, const bool de
 	return data.bActive && data.bState && ((debounce && data.bChanged) || !debounce);
 }
 
+/** check whether a button was let go since the last update.
+ * @param action digital input action.
+ * @return flag, whether the button changed from down to up.
+ */
+bool OpenVRInterface::getButtonLifted(const input_action_t action) const
+{
+	std::map<input_action_t, vr::VRInputValueHandle_t>::const_iterator iter = m_input_handle.find(action);
+
+	if (iter == m_input_handle.end())
+	{
+		throw std::runtime_error("invalid input action");
+	}
+
+	vr::InputDigitalActionData_t data;
+	vr::EVRInputError error = vr::VRInput()->GetDigitalActionData(iter->second, &data, sizeof(data), vr::k_ulInvalidInputValueHandle);
+
+	if (error != vr::VRInputError_None)
+	{
+		throw std::runtime_error("failed reading digital action status: " + std::to_string(error));
+	}
+
+	return data.bActive && !data.bState && data.bChanged;
+}
+
 glm::vec3 OpenVRInterface::getButtonPosition(const input_action_t action) const
 {
 	std::map<input_action_t, vr::VRInputValueHandle_t>::const_iterator iter = m_input_handle.find(action);
@@ -298,19 +346,24 @@ const OpenVRInterface::input_state_t& OpenVRInterface::read_input(void)
 {
 	m_input_state.system.pressed  = getButtonAction(INPUT_SYSTEM, false);
 	m_input_state.system.released = getButtonAction(INPUT_SYSTEM, true);
+	m_input_state.system.lifted   = getButtonLifted(INPUT_SYSTEM);
 
 	m_input_state.menu.pressed  = getButtonAction(INPUT_MENU, false);
 	m_input_state.menu.released = getButtonAction(INPUT_MENU, true);
+	m_input_state.menu.lifted   = getButtonLifted(INPUT_MENU);
 
 	m_input_state.grip.pressed  = getButtonAction(INPUT_GRIP, false);
 	m_input_state.grip.released = getButtonAction(INPUT_GRIP, true);
+	m_input_state.grip.lifted   = getButtonLifted(INPUT_GRIP);
 
 	m_input_state.trigger.button.pressed  = getButtonAction(INPUT_TRIGGER, false);
 	m_input_state.trigger.button.released = getButtonAction(INPUT_TRIGGER, true);
+	m_input_state.trigger.button.lifted   = getButtonLifted(INPUT_TRIGGER);
 	m_input_state.trigger.value = getButtonPosition(INPUT_TRIGGER_VALUE).x;
 
 	m_input_state.pad.button.pressed  = getButtonAction(INPUT_PADCLICK, false);
 	m_input_state.pad.button.released = getButtonAction(INPUT_PADCLICK, true);
+	m_input_state.pad.button.lifted   = getButtonLifted(INPUT_PADCLICK);
 	m_input_state.pad.position = glm::vec2(getButtonPosition(INPUT_ANALOG));
 	m_input_state.pad.touched = (glm::length(m_input_state.pad.position) > 0.0f);
 
@@ -36,8 +36,9 @@ class OpenVRInterface
 
 		typedef struct
 		{
-			bool pressed;
-			bool released;
+			bool pressed;           /* held down */
+			bool released;          /* pressed down in this frame */
+			bool lifted;            /* let go in this frame */
 		}
 		button_state_t;
 
@@ -66,6 +67,14 @@ class OpenVRInterface
 		}
 		input_state_t;
 
+		typedef struct
+		{
+			float refresh_rate;     /* refresh rate of the display in Hz, 0 if unknown */
+			float display_delay;    /* seconds until a frame rendered now is displayed */
+			uint64_t vsync;         /* vsync counter of the display */
+		}
+		frame_timing_t;
+
 		OpenVRInterface(void);
 		~OpenVRInterface(void);
 
@@ -81,9 +90,11 @@ class OpenVRInterface
 		vr::ETrackedDeviceClass device_class(const vr::TrackedDeviceIndex_t device) const;
 		void submit(const vr::Hmd_Eye eye, const GLuint texture_id) const;
 		void handoff(void) const;
+		frame_timing_t frame_timing(void) const;
 
 		void update(void) const;
 		bool getButtonAction(const input_action_t action, const bool debounce = true) const;
+		bool getButtonLifted(const input_action_t action) const;
 		glm::vec3 getButtonPosition(const input_action_t action) const;
 		void haptic(const input_action_t input) const;
 		float battery(const vr::TrackedDeviceIndex_t device) const;
@@ -0,0 +1,476 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "zip_archive.h"
+
+#include <sys/stat.h>
+#include <zlib.h>
+#include <stdexcept>
+#include <algorithm>
+#include <mutex>
+
+static const uint32_t signature_local_header = 0x04034b50;
+static const uint32_t signature_central_header = 0x02014b50;
+static const uint32_t signature_end_of_directory = 0x06054b50;
+static const uint32_t signature_zip64_locator = 0x07064b50;
+static const uint32_t signature_zip64_end_of_directory = 0x06064b50;
+
+static const size_t size_local_header = 30;
+static const size_t size_central_header = 46;
+static const size_t size_end_of_directory = 22;
+static const size_t size_zip64_locator = 20;
+static const size_t size_zip64_end_of_directory = 56;
+static const size_t max_comment_length = 0xFFFF;
+
+static const uint16_t method_stored = 0;
+static const uint16_t method_deflated = 8;
+static const uint16_t flag_encrypted = 0x0001;
+static const uint16_t extra_zip64 = 0x0001;
+
+static const size_t chunk_size = 256 * 1024;
+
+/* number of parsed archives kept by ZipArchive::open() */
+static const size_t max_cached_archives = 8;
+
+/* largest member read into memory, also keeping the output size of a single inflate() call within 32 bits */
+static const uint64_t max_member_size = 512 * 1024 * 1024;
+
+static uint16_t read_u16(const uint8_t* p)
+{
+	return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+static uint32_t read_u32(const uint8_t* p)
+{
+	return static_cast<uint32_t>(p[0]) |
+	       (static_cast<uint32_t>(p[1]) << 8) |
+	       (static_cast<uint32_t>(p[2]) << 16) |
+	       (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static uint64_t read_u64(const uint8_t* p)
+{
+	return static_cast<uint64_t>(read_u32(p)) | (static_cast<uint64_t>(read_u32(p + 4)) << 32);
+}
+
+static void read_at(std::ifstream& file, const uint64_t offset, std::vector<uint8_t>& buffer)
+{
+	file.clear();
+	file.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+	file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+
+	if (static_cast<size_t>(file.gcount()) != buffer.size())
+	{
+		throw std::runtime_error("unexpected end of zip archive");
+	}
+}
+
+/** open a zip archive and read its central directory.
+ * Only the central directory is read, member data is read on demand.
+ * @param file_name path of the archive.
+ */
+ZipArchive::ZipArchive(const std::string& file_name) :
+	m_file_name(file_name),
+	m_entries(),
+	m_directories()
+{
+	std::ifstream file(file_name, std::ios::in | std::ios::binary);
+
+	if (!file.is_open())
+	{
+		throw std::runtime_error("could not open archive " + file_name);
+	}
+	read_central_directory(file);
+}
+
+/** open a zip archive using a process wide cache.
+ * The central directory of an archive is parsed only once,
+ * as long as size and modification time of the archive do not change.
+ * The cache keeps the most recently opened archives only, older ones are freed when no longer in use.
+ * @param file_name path of the archive.
+ * @return parsed archive index.
+ */
+std::shared_ptr<const ZipArchive> ZipArchive::open(const std::string& file_name)
+{
+	typedef struct
+	{
+		off_t size;
+		time_t mtime;
+		uint64_t last_use;
+		std::shared_ptr<const ZipArchive> archive;
+	}
+	cache_entry_t;
+
+	static std::mutex cache_mutex;
+	static std::map<std::string, cache_entry_t> cache;
+	static uint64_t use_count = 0;
+
+	struct stat sb;
+
+	if (stat(file_name.c_str(), &sb) || !S_ISREG(sb.st_mode))
+	{
+		throw std::runtime_error("archive not found: " + file_name);
+	}
+
+	std::lock_guard<std::mutex> lock(cache_mutex);
+	std::map<std::string, cache_entry_t>::iterator iter = cache.find(file_name);
+
+	use_count++;
+
+	if ((iter != cache.end()) && (iter->second.size == sb.st_size) && (iter->second.mtime == sb.st_mtime))
+	{
+		iter->second.last_use = use_count;
+		return iter->second.archive;
+	}
+
+	const cache_entry_t entry = {
+		sb.st_size,
+		sb.st_mtime,
+		use_count,
+		std::make_shared<const ZipArchive>(file_name)
+	};
+
+	cache.erase(file_name);
+
+	/* drop the least recently used archive */
+	if (cache.size() >= max_cached_archives)
+	{
+		std::map<std::string, cache_entry_t>::iterator oldest = cache.begin();
+
+		for (iter = cache.begin(); iter != cache.end(); ++iter)
+		{
+			if (iter->second.last_use < oldest->second.last_use)
+			{
+				oldest = iter;
+			}
+		}
+		cache.erase(oldest);
+	}
+
+	cache.insert(std::make_pair(file_name, entry));
+	return entry.archive;
+}
+
+void ZipArchive::read_central_directory(std::ifstream& file)
+{
+	file.seekg(0, std::ios::end);
+	const uint64_t file_size = static_cast<uint64_t>(file.tellg());
+
+	if (file_size < size_end_of_directory)
+	{
+		throw std::runtime_error("not a zip archive: " + m_file_name);
+	}
+
+	/* the end of central directory record is followed by a comment of up to 64 KiB */
+	const uint64_t tail_size = std::min<uint64_t>(file_size, size_end_of_directory + max_comment_length);
+	std::vector<uint8_t> tail(tail_size);
+	read_at(file, file_size - tail_size, tail);
+
+	size_t eocd = tail.size() - size_end_of_directory + 1;
+
+	do
+	{
+		eocd--;
+
+		if (read_u32(&tail[eocd]) == signature_end_of_directory)
+		{
+			break;
+		}
+	}
+	while (eocd > 0);
+
+	if (read_u32(&tail[eocd]) != signature_end_of_directory)
+	{
+		throw std::runtime_error("missing central directory in " + m_file_name);
+	}
+
+	uint64_t num_entries = read_u16(&tail[eocd + 10]);
+	uint64_t directory_size = read_u32(&tail[eocd + 12]);
+	uint64_t directory_offset = read_u32(&tail[eocd + 16]);
+
+	/* ZIP64 archives keep the real values in a separate record */
+	if ((eocd >= size_zip64_locator) && (read_u32(&tail[eocd - size_zip64_locator]) == signature_zip64_locator))
+	{
+		std::vector<uint8_t> record(size_zip64_end_of_directory);
+		read_at(file, read_u64(&tail[eocd - size_zip64_locator + 8]), record);
+
+		if (read_u32(record.data()) != signature_zip64_end_of_directory)
+		{
+			throw std::runtime_error("invalid zip64 directory in " + m_file_name);
+		}
+		num_entries = read_u64(&record[32]);
+		directory_size = read_u64(&record[40]);
+		directory_offset = read_u64(&record[48]);
+	}
+
+	if (directory_offset + directory_size > file_size)
+	{
+		throw std::runtime_error("invalid central directory in " + m_file_name);
+	}
+
+	std::vector<uint8_t> directory(directory_size);
+	read_at(file, directory_offset, directory);
+
+	size_t pos = 0;
+
+	for (uint64_t i = 0; i < num_entries; i++)
+	{
+		if ((pos + size_central_header > directory.size()) || (read_u32(&directory[pos]) != signature_central_header))
+		{
+			throw std::runtime_error("corrupt central directory in " + m_file_name);
+		}
+
+		const uint8_t* header = &directory[pos];
+		const size_t name_length = read_u16(header + 28);
+		const size_t extra_length = read_u16(header + 30);
+		const size_t comment_length = read_u16(header + 32);
+
+		if (pos + size_central_header + name_length + extra_length + comment_length > directory.size())
+		{
+			throw std::runtime_error("corrupt central directory in " + m_file_name);
+		}
+
+		entry_t entry = {
+			read_u32(header + 42),
+			read_u32(header + 20),
+			read_u32(header + 24),
+			read_u16(header + 10),
+			read_u16(header + 8)
+		};
+
+		const std::string name(reinterpret_cast<const char*>(header + size_central_header), name_length);
+
+		/* ZIP64 extended information replaces saturated 32 bit fields in fixed order */
+		const uint8_t* extra = header + size_central_header + name_length;
+		size_t e = 0;
+
+		while (e + 4 <= extra_length)
+		{
+			const uint16_t id = read_u16(extra + e);
+			const size_t length = read_u16(extra + e + 2);
+			const uint8_t* data = extra + e + 4;
+			const uint8_t* end = data + std::min(length, extra_length - e - 4);
+
+			if (id == extra_zip64)
+			{
+				if ((entry.uncompressed_size == 0xFFFFFFFF) && (data + 8 <= end))
+				{
+					entry.uncompressed_size = read_u64(data);
+					data += 8;
+				}
+
+				if ((entry.compressed_size == 0xFFFFFFFF) && (data + 8 <= end))
+				{
+					entry.compressed_size = read_u64(data);
+					data += 8;
+				}
+
+				if ((entry.local_header_offset == 0xFFFFFFFF) && (data + 8 <= end))
+				{
+					entry.local_header_offset = read_u64(data);
+				}
+			}
+			e += 4 + length;
+		}
+
+		add_entry(name, entry);
+		pos += size_central_header + name_length + extra_length + comment_length;
+	}
+}
+
+void ZipArchive::add_entry(const std::string& name, const entry_t& entry)
+{
+	if (name.empty())
+	{
+		return;
+	}
+
+	/* register all parent directories, since archives do not need to contain directory entries */
+	for (size_t i = name.find('/'); i != std::string::npos; i = name.find('/', i + 1))
+	{
+		m_directories.insert(name.substr(0, i));
+	}
+
+	if (name[name.size() - 1] != '/')
+	{
+		m_entries[name] = entry;
+	}
+}
+
+const std::string& ZipArchive::file_name(void) const
+{
+	return m_file_name;
+}
+
+bool ZipArchive::is_file(const std::string& member) const
+{
+	return m_entries.find(member) != m_entries.end();
+}
+
+bool ZipArchive::is_directory(const std::string& member) const
+{
+	return member.empty() || (m_directories.find(member) != m_directories.end());
+}
+
+/** get the uncompressed size of a file in the archive.
+ * @param member path of the file inside the archive.
+ * @return size in bytes, 0 if the member is not a file.
+ */
+uint64_t ZipArchive::size(const std::string& member) const
+{
+	std::map<std::string, entry_t>::const_iterator iter = m_entries.find(member);
+
+	return (iter == m_entries.end()) ? 0 : iter->second.uncompressed_size;
+}
+
+/** list the direct children of a directory inside the archive.
+ * @param directory member path of the directory, empty for the archive root.
+ * @param use_files include files.
+ * @param use_dirs include sub directories.
+ * @return names of the children relative to the directory.
+ */
+std::set<std::string> ZipArchive::names(const std::string& directory, const bool use_files, const bool use_dirs) const
+{
+	const std::string prefix = directory.empty() ? "" : (directory + "/");
+	std::set<std::string> entries;
+
+	if (use_files)
+	{
+		for (std::map<std::string, entry_t>::const_iterator iter = m_entries.lower_bound(prefix);
+		     (iter != m_entries.end()) && (iter->first.compare(0, prefix.size(), prefix) == 0);
+		     ++iter)
+		{
+			const std::string name = iter->first.substr(prefix.size());
+
+			if (name.find('/') == std::string::npos)
+			{
+				entries.insert(name);
+			}
+		}
+	}
+
+	if (use_dirs)
+	{
+		for (std::set<std::string>::const_iterator iter = m_directories.lower_bound(prefix);
+		     (iter != m_directories.end()) && (iter->compare(0, prefix.size(), prefix) == 0);
+		     ++iter)
+		{
+			const std::string name = iter->substr(prefix.size());
+
+			if (!name.empty() && (name.find('/') == std::string::npos))
+			{
+				entries.insert(name);
+			}
+		}
+	}
+	return entries;
+}
+
+/** read and decompress a single member of the archive.
+ * Only the local header and the data of the requested member are read from disk.
+ * @param member path of the member inside the archive.
+ * @return uncompressed content of the member.
+ */
+std::vector<uint8_t> ZipArchive::read(const std::string& member) const
+{
+	std::map<std::string, entry_t>::const_iterator iter = m_entries.find(member);
+
+	if (iter == m_entries.end())
+	{
+		throw std::runtime_error("no member " + member + " in archive " + m_file_name);
+	}
+
+	const entry_t& entry = iter->second;
+
+	if (entry.flags & flag_encrypted)
+	{
+		throw std::runtime_error("encrypted member " + member + " in archive " + m_file_name);
+	}
+
+	if ((entry.method != method_stored) && (entry.method != method_deflated))
+	{
+		throw std::runtime_error("unsupported compression of member " + member + " in archive " + m_file_name);
+	}
+
+	/* the size is taken from the archive, so it is checked before allocating the buffer */
+	if (entry.uncompressed_size > max_member_size)
+	{
+		throw std::runtime_error("member " + member + " too large in archive " + m_file_name);
+	}
+
+	std::ifstream file(m_file_name, std::ios::in | std::ios::binary);
+
+	if (!file.is_open())
+	{
+		throw std::runtime_error("could not open archive " + m_file_name);
+	}
+
+	/* the local header may have a different extra field than the central directory */
+	std::vector<uint8_t> header(size_local_header);
+	read_at(file, entry.local_header_offset, header);
+
+	if (read_u32(header.data()) != signature_local_header)
+	{
+		throw std::runtime_error("corrupt local header of " + member + " in archive " + m_file_name);
+	}
+
+	const uint64_t data_offset = entry.local_header_offset + size_local_header + read_u16(&header[26]) + read_u16(&header[28]);
+	std::vector<uint8_t> data(entry.uncompressed_size);
+
+	if (entry.method == method_stored)
+	{
+		read_at(file, data_offset, data);
+		return data;
+	}
+
+	z_stream stream;
+	stream.zalloc = nullptr;
+	stream.zfree = nullptr;
+	stream.opaque = nullptr;
+	stream.next_in = nullptr;
+	stream.avail_in = 0;
+
+	/* negative window bits: raw deflate stream without zlib header */
+	if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+	{
+		throw std::runtime_error("failed initializing decompression");
+	}
+
+	std::vector<uint8_t> chunk(chunk_size);
+	uint64_t remaining = entry.compressed_size;
+	int status = Z_OK;
+
+	file.clear();
+	file.seekg(static_cast<std::streamoff>(data_offset), std::ios::beg);
+	stream.next_out = data.data();
+	stream.avail_out = static_cast<uInt>(data.size());
+
+	while ((status == Z_OK) && (remaining > 0))
+	{
+		const size_t length = static_cast<size_t>(std::min<uint64_t>(remaining, chunk.size()));
+		file.read(reinterpret_cast<char*>(chunk.data()), static_cast<std::streamsize>(length));
+
+		if (static_cast<size_t>(file.gcount()) != length)
+		{
+			inflateEnd(&stream);
+			throw std::runtime_error("unexpected end of archive " + m_file_name);
+		}
+		remaining -= length;
+
+		stream.next_in = chunk.data();
+		stream.avail_in = static_cast<uInt>(length);
+
+		while ((status == Z_OK) && (stream.avail_in > 0))
+		{
+			status = inflate(&stream, Z_NO_FLUSH);
+		}
+	}
+	inflateEnd(&stream);
+
+	if ((status != Z_STREAM_END) || (stream.total_out != data.size()))
+	{
+		throw std::runtime_error("failed decompressing " + member + " in archive " + m_file_name);
+	}
+	return data;
+}
@@ -0,0 +1,49 @@
+// SPDX-FileCopyrightText: 2025 QuantumHole <QuantumHole@github.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef ZIP_ARCHIVE_H
+#define ZIP_ARCHIVE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <memory>
+#include <fstream>
+
+class ZipArchive
+{
+	private:
+		typedef struct
+		{
+			uint64_t local_header_offset;
+			uint64_t compressed_size;
+			uint64_t uncompressed_size;
+			uint16_t method;
+			uint16_t flags;
+		}
+		entry_t;
+
+		std::string m_file_name;
+		std::map<std::string, entry_t> m_entries;
+		std::set<std::string> m_directories;
+
+		void read_central_directory(std::ifstream& file);
+		void add_entry(const std::string& name, const entry_t& entry);
+
+	public:
+		explicit ZipArchive(const std::string& file_name);
+
+		static std::shared_ptr<const ZipArchive> open(const std::string& file_name);
+
+		const std::string& file_name(void) const;
+		bool is_file(const std::string& member) const;
+		bool is_directory(const std::string& member) const;
+		uint64_t size(const std::string& member) const;
+		std::set<std::string> names(const std::string& directory, const bool use_files, const bool use_dirs) const;
+		std::vector<uint8_t> read(const std::string& member) const;
+};
+
+#endif